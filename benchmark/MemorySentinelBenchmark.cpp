@@ -0,0 +1,81 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+// Cost of an unarmed new/delete pair, then the allocation throughput with the sentinel monitoring (statistics enabled,
+// unarmed) for an increasing number of threads, up to maxThreads. The speedup and efficiency columns show how well
+// the statistics scale on the machine it runs on.
+//
+// Usage: MemorySentinelBenchmark [maxThreads] [allocationsPerThread]
+
+#include "MemorySentinel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static double runAllocations(unsigned numThreads, int allocationsPerThread)
+{
+    std::atomic<bool> go { false };
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&go, allocationsPerThread]() {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < allocationsPerThread; ++i) {
+                // explicit calls: unlike new-expressions, these may not be elided by the compiler
+                void* block = ::operator new(static_cast<std::size_t>(16 + (i & 255)));
+                ::operator delete(block);
+            }
+        });
+    }
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(numThreads) * allocationsPerThread / elapsed.count();
+}
+
+int main(int argc, char* argv[])
+{
+    const unsigned hardwareThreads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+    const unsigned maxThreads = argc > 1 ? static_cast<unsigned>(std::max(1, std::atoi(argv[1]))) : hardwareThreads;
+    const int allocationsPerThread = argc > 2 ? std::atoi(argv[2]) : 1000000;
+
+    // the cost of the hooks alone: unarmed, without statistics (the configuration is read with a single pointer load)
+    printf("unarmed, statistics disabled: %.1f ns per new/delete pair\n\n", 1e9 / runAllocations(1, allocationsPerThread));
+
+    MemorySentinel::resetStatistics();
+    MemorySentinel::setStatisticsEnabled(true);
+
+    printf("threads  allocations/s  speedup  efficiency\n");
+    double singleThreaded = 0;
+    // powers of two, always finishing with maxThreads
+    for (unsigned numThreads = 1; ; numThreads = std::min(numThreads * 2, maxThreads)) {
+        const double throughput = runAllocations(numThreads, allocationsPerThread);
+        singleThreaded = (numThreads == 1) ? throughput : singleThreaded;
+        const double speedup = throughput / singleThreaded;
+        printf("%7u  %13.0f  %7.2f  %9.0f%%\n", numThreads, throughput, speedup, 100.0 * speedup / numThreads);
+        if (numThreads == maxThreads) {
+            break;
+        }
+    }
+
+    MemorySentinel::setStatisticsEnabled(false);
+    const auto stats = MemorySentinel::getStatistics();
+    printf("recorded %llu allocations, %llu deallocations\n",
+           static_cast<unsigned long long>(stats.allocations), static_cast<unsigned long long>(stats.deallocations));
+    return 0;
+}
@@ -0,0 +1,61 @@
+#  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+#  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+#  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+#
+# Generates a single-header version of MemorySentinel: all headers (in include order), followed by all sources,
+# which are only compiled where SLB_MEMORY_SENTINEL_IMPLEMENTATION is defined.
+#
+# Usage: cmake -DSOURCE_DIR=<repo>/source -DOUTPUT=<path>/MemorySentinel.hpp -P amalgamate.cmake
+
+if (NOT SOURCE_DIR OR NOT OUTPUT)
+  message(FATAL_ERROR "Usage: cmake -DSOURCE_DIR=<dir> -DOUTPUT=<file> -P amalgamate.cmake")
+endif()
+
+# Returns the content of a file with its local includes expanded (each file is only expanded once)
+function(amalgamate_file FILE_NAME OUT_VAR)
+  get_property(alreadyExpanded GLOBAL PROPERTY "AMALGAMATED_${FILE_NAME}")
+  if (alreadyExpanded)
+    set(${OUT_VAR} "" PARENT_SCOPE)
+    return()
+  endif()
+  set_property(GLOBAL PROPERTY "AMALGAMATED_${FILE_NAME}" TRUE)
+
+  file(READ "${SOURCE_DIR}/${FILE_NAME}" content)
+  string(REGEX REPLACE "^(//[^\n]*\n)+" "" content "${content}") # file banner
+  string(REPLACE "#pragma once\n" "" content "${content}")
+
+  string(REGEX MATCHALL "#include \"[A-Za-z0-9_]+\\.hpp\"" localIncludes "${content}")
+  foreach(localInclude IN LISTS localIncludes)
+    string(REGEX REPLACE "#include \"(.+)\"" "\\1" header "${localInclude}")
+    amalgamate_file(${header} expanded)
+    string(REPLACE "${localInclude}\n" "${expanded}" content "${content}")
+  endforeach()
+  set(${OUT_VAR} "// ---- ${FILE_NAME} ----\n${content}\n" PARENT_SCOPE)
+endfunction()
+
+file(READ "${SOURCE_DIR}/MemorySentinel.hpp" banner)
+string(REGEX MATCH "^(//[^\n]*\n)+" banner "${banner}")
+
+file(GLOB headers RELATIVE "${SOURCE_DIR}" "${SOURCE_DIR}/*.hpp")
+file(GLOB sources RELATIVE "${SOURCE_DIR}" "${SOURCE_DIR}/*.cpp")
+list(SORT headers)
+list(SORT sources)
+list(REMOVE_ITEM headers MemorySentinel.hpp)
+list(PREPEND headers MemorySentinel.hpp)
+
+set(result "${banner}//  Single-header version, generated from the sources by deploy/amalgamate.cmake - do not edit\n")
+string(APPEND result "//  Define SLB_MEMORY_SENTINEL_IMPLEMENTATION in exactly one translation unit before including this file.\n\n")
+string(APPEND result "#pragma once\n\n")
+foreach(header IN LISTS headers)
+  amalgamate_file(${header} expanded)
+  string(APPEND result "${expanded}")
+endforeach()
+
+string(APPEND result "#ifdef SLB_MEMORY_SENTINEL_IMPLEMENTATION\n\n")
+foreach(sourceFile IN LISTS sources)
+  amalgamate_file(${sourceFile} expanded)
+  string(APPEND result "${expanded}")
+endforeach()
+string(APPEND result "#endif // SLB_MEMORY_SENTINEL_IMPLEMENTATION\n")
+
+file(WRITE "${OUTPUT}" "${result}")
@@ -0,0 +1,155 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include "MemorySentinel.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+/**
+ * Allocation baseline for regression gating (e.g. in CI): the allocation count and bytes per name (a test, a section or
+ * a tag), written to a text file with one "<allocations> <bytes> <name>" line per entry. A later run compares its
+ * measurements against it and reports a regression if a name allocates more than its baseline plus the tolerance.
+ * Names without a baseline entry never regress.
+ *
+ * The test integrations (integration/catch2, integration/gtest) are configured through the environment:
+ * - MEMORY_SENTINEL_BASELINE=<path>: compare against the file if it exists, write it otherwise
+ * - MEMORY_SENTINEL_BASELINE_UPDATE=1: always (re-)write the file
+ * - MEMORY_SENTINEL_BASELINE_TOLERANCE=<fraction>: permitted relative increase, e.g. 0.1 (default: 0)
+ */
+class MemorySentinelBaseline
+{
+public:
+    struct Entry
+    {
+        std::uint64_t allocations = 0;
+        std::uint64_t allocatedBytes = 0;
+    };
+
+    enum class Mode
+    {
+        DISABLED,
+        WRITE,
+        COMPARE
+    };
+
+    /** Reads the configuration from the environment; in COMPARE mode, the baseline file is loaded */
+    static MemorySentinelBaseline fromEnvironment()
+    {
+        MemorySentinelBaseline baseline;
+        const char* path = std::getenv("MEMORY_SENTINEL_BASELINE");
+        if (path == nullptr || *path == '\0') {
+            return baseline;
+        }
+        baseline.m_path = path;
+        if (const char* tolerance = std::getenv("MEMORY_SENTINEL_BASELINE_TOLERANCE")) {
+            baseline.m_tolerance = std::strtod(tolerance, nullptr);
+        }
+        const char* update = std::getenv("MEMORY_SENTINEL_BASELINE_UPDATE");
+        const bool isUpdate = update != nullptr && *update != '\0' && std::strcmp(update, "0") != 0;
+        baseline.m_mode = (!isUpdate && baseline.load(baseline.m_path)) ? Mode::COMPARE : Mode::WRITE;
+        return baseline;
+    }
+
+    Mode getMode() const noexcept { return m_mode; }
+    const std::string& getPath() const noexcept { return m_path; }
+
+    double getTolerance() const noexcept { return m_tolerance; }
+    void setTolerance(double tolerance) noexcept { m_tolerance = tolerance; }
+
+    /** Replaces the entries with those of a baseline file. Returns false if it can't be read. */
+    bool load(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file) {
+            return false;
+        }
+        m_entries.clear();
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            Entry entry;
+            std::string name;
+            if (fields >> entry.allocations >> entry.allocatedBytes && std::getline(fields >> std::ws, name) && !name.empty()) {
+                m_entries[name] = entry;
+            }
+        }
+        return true;
+    }
+
+    /** Writes the entries to a baseline file (sorted by name, so baselines diff well). Returns false on error. */
+    bool save(const std::string& path) const
+    {
+        std::ofstream file(path);
+        for (const auto& entry : m_entries) {
+            file << entry.second.allocations << " " << entry.second.allocatedBytes << " " << entry.first << "\n";
+        }
+        return static_cast<bool>(file);
+    }
+
+    void set(const std::string& name, Entry entry) { m_entries[name] = entry; }
+    const Entry* find(const std::string& name) const
+    {
+        const auto it = m_entries.find(name);
+        return it != m_entries.end() ? &it->second : nullptr;
+    }
+    const std::map<std::string, Entry>& getEntries() const noexcept { return m_entries; }
+
+    /** Sets an entry "tag:<name>" for each tag of the statistics (see MemorySentinel::getTopTags) */
+    void setTags()
+    {
+        MemorySentinel::Tag tags[256];
+        const std::size_t count = MemorySentinel::getTopTags(tags, sizeof(tags) / sizeof(tags[0]));
+        for (std::size_t i = 0; i < count; ++i) {
+            Entry entry;
+            entry.allocations = tags[i].allocations;
+            entry.allocatedBytes = tags[i].allocatedBytes;
+            set(std::string("tag:") + tags[i].name, entry);
+        }
+    }
+
+    /**
+     * True if measured exceeds the baseline entry of name (in allocations or bytes) by more than the tolerance.
+     * @param description if not nullptr, receives a description of the regression
+     */
+    bool isRegression(const std::string& name, Entry measured, std::string* description = nullptr) const
+    {
+        const Entry* baseline = find(name);
+        if (baseline == nullptr || (measured.allocations <= limit(baseline->allocations)
+                                    && measured.allocatedBytes <= limit(baseline->allocatedBytes))) {
+            return false;
+        }
+        if (description != nullptr) {
+            std::ostringstream text;
+            text << "MemorySentinel: allocation regression in '" << name << "': " << measured.allocations
+                 << " allocations / " << measured.allocatedBytes << " bytes, baseline " << baseline->allocations
+                 << " / " << baseline->allocatedBytes << " (tolerance " << m_tolerance * 100 << "%)";
+            *description = text.str();
+        }
+        return true;
+    }
+
+private:
+    std::uint64_t limit(std::uint64_t baseline) const noexcept
+    {
+        return baseline + static_cast<std::uint64_t>(std::floor(static_cast<double>(baseline) * m_tolerance));
+    }
+
+    Mode m_mode = Mode::DISABLED;
+    std::string m_path;
+    double m_tolerance = 0.0;
+    std::map<std::string, Entry> m_entries;
+};
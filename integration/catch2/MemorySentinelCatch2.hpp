@@ -0,0 +1,243 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include "MemorySentinel.hpp"
+#include "../MemorySentinelBaseline.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * Catch2 (v2) integration:
+ * - SLB_ALLOCATION_BUDGET(maxAllocations[, maxBytes]) CHECKs that the rest of the enclosing block allocates within the
+ *   budget (counted on the calling thread, including Catch's own allocations, e.g. for assertions).
+ * - A listener that records the allocations of each TEST_CASE and SECTION and prints a table sorted by allocations
+ *   when the run ends. It is registered in the translation unit that defines CATCH_CONFIG_MAIN (or CATCH_CONFIG_RUNNER)
+ *   and reports if the environment variable MEMORY_SENTINEL_REPORT is set (and not "0"). With a baseline file (see
+ *   MemorySentinelBaseline), it writes the records to it, or fails the test cases and sections that allocate more.
+ * Allocations are counted with MemorySentinel::getThreadCounters(), i.e. they are counted without arming the sentinel
+ * and without enabling statistics, on the thread that runs the tests.
+ */
+namespace MemorySentinelCatch2
+{
+
+/** Allocations made by the listener itself on this thread (excluded from all measurements) */
+inline MemorySentinel::ThreadCounters& listenerOverhead() noexcept
+{
+    static thread_local MemorySentinel::ThreadCounters overhead;
+    return overhead;
+}
+
+/** Counters of the calling thread, without the allocations of the listener */
+inline MemorySentinel::ThreadCounters measure() noexcept
+{
+    MemorySentinel::ThreadCounters counters = MemorySentinel::getThreadCounters();
+    const MemorySentinel::ThreadCounters& overhead = listenerOverhead();
+    counters.allocations -= overhead.allocations;
+    counters.deallocations -= overhead.deallocations;
+    counters.allocatedBytes -= overhead.allocatedBytes;
+    return counters;
+}
+
+/** Attributes the allocations within its scope to the listener */
+class ScopedListenerOverhead
+{
+public:
+    ScopedListenerOverhead() noexcept : m_start(MemorySentinel::getThreadCounters()) {}
+    ~ScopedListenerOverhead()
+    {
+        const MemorySentinel::ThreadCounters end = MemorySentinel::getThreadCounters();
+        MemorySentinel::ThreadCounters& overhead = listenerOverhead();
+        overhead.allocations += end.allocations - m_start.allocations;
+        overhead.deallocations += end.deallocations - m_start.deallocations;
+        overhead.allocatedBytes += end.allocatedBytes - m_start.allocatedBytes;
+    }
+    ScopedListenerOverhead(const ScopedListenerOverhead&) = delete;
+    ScopedListenerOverhead& operator= (const ScopedListenerOverhead&) = delete;
+
+private:
+    MemorySentinel::ThreadCounters m_start;
+};
+
+/** See SLB_ALLOCATION_BUDGET */
+class AllocationBudget
+{
+public:
+    explicit AllocationBudget(std::uint64_t maxAllocations, std::uint64_t maxBytes = UINT64_MAX) noexcept
+        : m_maxAllocations(maxAllocations)
+        , m_maxBytes(maxBytes)
+        , m_start(measure())
+    {}
+
+    ~AllocationBudget()
+    {
+        const MemorySentinel::ThreadCounters end = measure();
+        const std::uint64_t allocations = end.allocations - m_start.allocations;
+        const std::uint64_t allocatedBytes = end.allocatedBytes - m_start.allocatedBytes;
+        CHECK(allocations <= m_maxAllocations);
+        CHECK(allocatedBytes <= m_maxBytes);
+    }
+
+    AllocationBudget(const AllocationBudget&) = delete;
+    AllocationBudget& operator= (const AllocationBudget&) = delete;
+
+private:
+    std::uint64_t m_maxAllocations;
+    std::uint64_t m_maxBytes;
+    MemorySentinel::ThreadCounters m_start;
+};
+
+/** Allocations of one TEST_CASE or SECTION, summed over all its runs */
+struct Record
+{
+    std::uint64_t runs = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::uint64_t allocatedBytes = 0;
+};
+
+inline bool isReportEnabled() noexcept
+{
+    const char* value = std::getenv("MEMORY_SENTINEL_REPORT");
+    return value != nullptr && *value != '\0' && std::strcmp(value, "0") != 0;
+}
+
+#if defined(CATCH_CONFIG_EXTERNAL_INTERFACES)
+/** Records the allocations of each section (the outermost section of a test case is the test case itself) */
+class AllocationListener : public Catch::TestEventListenerBase
+{
+public:
+    using TestEventListenerBase::TestEventListenerBase;
+
+    void sectionStarting(const Catch::SectionInfo& sectionInfo) override
+    {
+        TestEventListenerBase::sectionStarting(sectionInfo);
+        if (!m_isReportEnabled && m_baseline.getMode() == MemorySentinelBaseline::Mode::DISABLED) {
+            return;
+        }
+        {
+            ScopedListenerOverhead overhead;
+            m_path.push_back(m_path.empty() ? sectionInfo.name : m_path.back() + " / " + sectionInfo.name);
+            m_starts.emplace_back();
+        }
+        m_starts.back() = measure();
+    }
+
+    void sectionEnded(const Catch::SectionStats& sectionStats) override
+    {
+        if (!m_starts.empty()) {
+            const MemorySentinel::ThreadCounters end = measure();
+            ScopedListenerOverhead overhead;
+            const MemorySentinel::ThreadCounters& start = m_starts.back();
+            Record& record = m_records[m_path.back()];
+            record.runs++;
+            record.allocations += end.allocations - start.allocations;
+            record.deallocations += end.deallocations - start.deallocations;
+            record.allocatedBytes += end.allocatedBytes - start.allocatedBytes;
+            checkBaseline(m_path.back(), record);
+            m_path.pop_back();
+            m_starts.pop_back();
+        }
+        TestEventListenerBase::sectionEnded(sectionStats);
+    }
+
+    void testRunEnded(const Catch::TestRunStats& testRunStats) override
+    {
+        ScopedListenerOverhead overhead;
+        if (m_isReportEnabled) {
+            writeReport();
+        }
+        if (m_baseline.getMode() == MemorySentinelBaseline::Mode::WRITE) {
+            writeBaseline();
+        }
+        TestEventListenerBase::testRunEnded(testRunStats);
+    }
+
+private:
+    /**
+     * The records only grow over the runs of a section, so checking after each run fails the section as soon as it
+     * exceeds its baseline (once), and while it is still running, so the failure counts for its test case.
+     */
+    void checkBaseline(const std::string& path, const Record& record)
+    {
+        if (m_baseline.getMode() != MemorySentinelBaseline::Mode::COMPARE) {
+            return;
+        }
+        MemorySentinelBaseline::Entry measured;
+        measured.allocations = record.allocations;
+        measured.allocatedBytes = record.allocatedBytes;
+        std::string description;
+        if (m_baseline.isRegression(path, measured, &description) && m_regressions.insert(path).second) {
+            FAIL_CHECK(description);
+        }
+    }
+
+    void writeBaseline()
+    {
+        for (const auto& entry : m_records) {
+            MemorySentinelBaseline::Entry baseline;
+            baseline.allocations = entry.second.allocations;
+            baseline.allocatedBytes = entry.second.allocatedBytes;
+            m_baseline.set(entry.first, baseline);
+        }
+        const bool isWritten = m_baseline.save(m_baseline.getPath());
+        stream << "\n[MemorySentinel] " << (isWritten ? "baseline written to " : "could not write baseline ")
+               << m_baseline.getPath() << "\n";
+    }
+
+    void writeReport()
+    {
+        std::vector<const std::pair<const std::string, Record>*> sorted;
+        for (const auto& entry : m_records) {
+            sorted.push_back(&entry);
+        }
+        std::stable_sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) {
+            return a->second.allocations != b->second.allocations ? a->second.allocations > b->second.allocations
+                                                                  : a->second.allocatedBytes > b->second.allocatedBytes;
+        });
+        stream << "\n[MemorySentinel] allocations per test case / section:\n"
+               << std::setw(12) << "allocations" << std::setw(14) << "deallocations" << std::setw(14) << "bytes"
+               << std::setw(7) << "runs" << "  name\n";
+        for (const auto* entry : sorted) {
+            const Record& record = entry->second;
+            stream << std::setw(12) << record.allocations << std::setw(14) << record.deallocations
+                   << std::setw(14) << record.allocatedBytes << std::setw(7) << record.runs << "  " << entry->first << "\n";
+        }
+        stream.flush();
+    }
+
+    bool m_isReportEnabled = isReportEnabled();
+    MemorySentinelBaseline m_baseline = MemorySentinelBaseline::fromEnvironment();
+    std::set<std::string> m_regressions;
+    std::vector<std::string> m_path;
+    std::vector<MemorySentinel::ThreadCounters> m_starts;
+    std::map<std::string, Record> m_records;
+};
+#endif // CATCH_CONFIG_EXTERNAL_INTERFACES
+
+} // namespace MemorySentinelCatch2
+
+/** CHECKs that the rest of the enclosing block makes at most maxAllocations allocations (and maxBytes bytes) */
+#define SLB_ALLOCATION_BUDGET(...) \
+    MemorySentinelCatch2::AllocationBudget INTERNAL_CATCH_UNIQUE_NAME(slbAllocationBudget)(__VA_ARGS__)
+
+#if (defined(CATCH_CONFIG_MAIN) || defined(CATCH_CONFIG_RUNNER)) && defined(CATCH_CONFIG_EXTERNAL_INTERFACES)
+using MemorySentinelAllocationListener = MemorySentinelCatch2::AllocationListener; // the macro needs an unqualified name
+CATCH_REGISTER_LISTENER(MemorySentinelAllocationListener)
+#endif
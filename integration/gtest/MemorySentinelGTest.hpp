@@ -0,0 +1,185 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include "MemorySentinel.hpp"
+#include "../MemorySentinelBaseline.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * GoogleTest integration:
+ * - EXPECT_NO_ALLOCATIONS(statement) / ASSERT_NO_ALLOCATIONS(statement) and
+ *   EXPECT_MAX_ALLOCATED_BYTES(statement, n) / ASSERT_MAX_ALLOCATED_BYTES(statement, n) run the statement within a
+ *   ScopedMemorySentinel (silent, without quota) and check the allocations it made on the calling thread.
+ *   Allocations exempted by ScopedAllowAllocation or the allowlist are not counted.
+ * - AllocationListener records the allocations of each test and prints a table sorted by allocations when the program
+ *   ends, if the environment variable MEMORY_SENTINEL_REPORT is set (and not "0"), see installListener(). With a
+ *   baseline file (see MemorySentinelBaseline), the records are written to it, or compared against it when the global
+ *   test environment tears down (a regression fails the test program).
+ */
+namespace MemorySentinelGTest
+{
+
+/** Allocations of one test */
+struct Record
+{
+    std::string name; ///< "Suite.Test"
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::uint64_t allocatedBytes = 0;
+};
+
+inline bool isReportEnabled() noexcept
+{
+    const char* value = std::getenv("MEMORY_SENTINEL_REPORT");
+    return value != nullptr && *value != '\0' && std::strcmp(value, "0") != 0;
+}
+
+/** Records the allocations of each test on the thread that runs the tests (see MemorySentinel::getThreadCounters) */
+class AllocationListener : public ::testing::EmptyTestEventListener
+{
+public:
+    void OnTestStart(const ::testing::TestInfo&) override
+    {
+        m_start = MemorySentinel::getThreadCounters();
+    }
+
+    void OnTestEnd(const ::testing::TestInfo& testInfo) override
+    {
+        const MemorySentinel::ThreadCounters end = MemorySentinel::getThreadCounters();
+        Record record;
+        record.allocations = end.allocations - m_start.allocations;
+        record.deallocations = end.deallocations - m_start.deallocations;
+        record.allocatedBytes = end.allocatedBytes - m_start.allocatedBytes;
+        record.name = std::string(testInfo.test_suite_name()) + "." + testInfo.name();
+        m_records.push_back(record);
+    }
+
+    void OnTestProgramEnd(const ::testing::UnitTest&) override
+    {
+        if (m_isReportEnabled) {
+            writeReport(std::cout);
+        }
+    }
+
+    const std::vector<Record>& getRecords() const noexcept { return m_records; }
+
+private:
+    void writeReport(std::ostream& stream) const
+    {
+        std::vector<Record> sorted = m_records;
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Record& a, const Record& b) {
+            return a.allocations != b.allocations ? a.allocations > b.allocations : a.allocatedBytes > b.allocatedBytes;
+        });
+        stream << "\n[MemorySentinel] allocations per test:\n"
+               << std::setw(12) << "allocations" << std::setw(14) << "deallocations" << std::setw(14) << "bytes"
+               << "  name\n";
+        for (const Record& record : sorted) {
+            stream << std::setw(12) << record.allocations << std::setw(14) << record.deallocations
+                   << std::setw(14) << record.allocatedBytes << "  " << record.name << "\n";
+        }
+        stream.flush();
+    }
+
+    bool m_isReportEnabled = isReportEnabled();
+    MemorySentinel::ThreadCounters m_start;
+    std::vector<Record> m_records;
+};
+
+/** Writes or compares the baseline with the records of an AllocationListener, once all tests have run */
+class BaselineEnvironment : public ::testing::Environment
+{
+public:
+    BaselineEnvironment(const AllocationListener& listener, MemorySentinelBaseline baseline)
+        : m_listener(listener)
+        , m_baseline(std::move(baseline))
+    {}
+
+    void TearDown() override
+    {
+        for (const Record& record : m_listener.getRecords()) {
+            MemorySentinelBaseline::Entry measured;
+            measured.allocations = record.allocations;
+            measured.allocatedBytes = record.allocatedBytes;
+            std::string description;
+            if (m_baseline.getMode() == MemorySentinelBaseline::Mode::WRITE) {
+                m_baseline.set(record.name, measured);
+            } else if (m_baseline.isRegression(record.name, measured, &description)) {
+                ADD_FAILURE() << description;
+            }
+        }
+        if (m_baseline.getMode() == MemorySentinelBaseline::Mode::WRITE && !m_baseline.save(m_baseline.getPath())) {
+            ADD_FAILURE() << "MemorySentinel: could not write baseline " << m_baseline.getPath();
+        }
+    }
+
+private:
+    const AllocationListener& m_listener;
+    MemorySentinelBaseline m_baseline;
+};
+
+/**
+ * Appends an AllocationListener to GoogleTest's listeners (which own it), and a BaselineEnvironment if a baseline file
+ * is configured. Call after InitGoogleTest() and before RUN_ALL_TESTS().
+ */
+inline AllocationListener* installListener()
+{
+    auto* listener = new AllocationListener();
+    ::testing::UnitTest::GetInstance()->listeners().Append(listener);
+    MemorySentinelBaseline baseline = MemorySentinelBaseline::fromEnvironment();
+    if (baseline.getMode() != MemorySentinelBaseline::Mode::DISABLED) {
+        ::testing::AddGlobalTestEnvironment(new BaselineEnvironment(*listener, std::move(baseline)));
+    }
+    return listener;
+}
+
+} // namespace MemorySentinelGTest
+
+// Runs statement within a silent scope without quota and leaves the scope's final state in `scope`
+#define SLB_GTEST_MEASURE_(statement, scope) \
+    MemorySentinel::Scope scope; \
+    { \
+        ScopedMemorySentinel slbGTestSentinel(0, MemorySentinel::TransgressionBehaviour::SILENT); \
+        statement; \
+        scope = slbGTestSentinel.getScope(); \
+    }
+
+#define SLB_GTEST_NO_ALLOCATIONS_(statement, fail) \
+    do { \
+        SLB_GTEST_MEASURE_(statement, slbGTestScope) \
+        if (slbGTestScope.allocations != 0) { \
+            fail() << "MemorySentinel: `" #statement "` made " << slbGTestScope.allocations << " allocation(s) of " \
+                   << slbGTestScope.allocatedBytes << " bytes in total"; \
+        } \
+    } while (false)
+
+#define SLB_GTEST_MAX_ALLOCATED_BYTES_(statement, maxBytes, fail) \
+    do { \
+        SLB_GTEST_MEASURE_(statement, slbGTestScope) \
+        if (slbGTestScope.allocatedBytes > static_cast<std::uint64_t>(maxBytes)) { \
+            fail() << "MemorySentinel: `" #statement "` allocated " << slbGTestScope.allocatedBytes \
+                   << " bytes (" << slbGTestScope.allocations << " allocation(s)), expected at most " << (maxBytes); \
+        } \
+    } while (false)
+
+#define EXPECT_NO_ALLOCATIONS(statement) SLB_GTEST_NO_ALLOCATIONS_(statement, ADD_FAILURE)
+#define ASSERT_NO_ALLOCATIONS(statement) SLB_GTEST_NO_ALLOCATIONS_(statement, FAIL)
+#define EXPECT_MAX_ALLOCATED_BYTES(statement, maxBytes) SLB_GTEST_MAX_ALLOCATED_BYTES_(statement, maxBytes, ADD_FAILURE)
+#define ASSERT_MAX_ALLOCATED_BYTES(statement, maxBytes) SLB_GTEST_MAX_ALLOCATED_BYTES_(statement, maxBytes, FAIL)
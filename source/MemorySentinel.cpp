@@ -7,18 +7,316 @@
 //  https://github.com/Sidelobe/MemorySentinel
 
 #include "MemorySentinel.hpp"
+#include "MemorySentinelControl.hpp"
+#include "MemorySentinelLiveAllocations.hpp"
+#include "MemorySentinelPool.hpp"
+#include "MemorySentinelSampler.hpp"
+#include "MemorySentinelShards.hpp"
+#include "MemorySentinelStatistics.hpp"
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <future>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <type_traits>
 
 // Note: malloc overwrite only supported on GCC / Clang
 #if defined(__clang__) || defined(__GNUC__)
     #include <dlfcn.h>
     #if defined(__GLIBC__ )
         #include <malloc.h>
+    #elif defined(__APPLE__)
+        #include <malloc/malloc.h>
     #endif
+#elif defined(_MSC_VER)
+    #include <intrin.h>
+    #include <malloc.h>
 #endif
+#if defined(__linux__) || defined(__FreeBSD__)
+    #include <link.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+    #include <pthread.h>
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Configuration
+// The hooks only ever read the configuration through `publishedConfig`: an acquire load of the pointer to one of a ring
+// of cache-line-aligned blocks, which is immutable while published, and a copy of it. Readers never write. A writer
+// refills the oldest retired block (reuse is deferred by the length of the ring) and publishes it with a single atomic
+// store. Its sequence number is odd while the writer refills it, so the rare reader still copying a reused block sees
+// the change and retries: writers never wait for readers, and readers never wait either unless they lag a full ring.
+// Arming is not part of the block: it is a count of the armed threads, checked first by the hooks, so arming and
+// disarming never lock nor wait.
+
+/** Publishes copies of a trivially copyable value (see above). Except for read(), only call with configWriteMutex held. */
+template<class T, std::size_t NUM_BLOCKS>
+class PublishedValue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "the value is copied word by word");
+    static constexpr std::size_t NUM_WORDS = (sizeof(T) + sizeof(std::uintptr_t) - 1) / sizeof(std::uintptr_t);
+
+    struct alignas(MemorySentinelShards::CACHE_LINE_SIZE) Block
+    {
+        std::atomic<std::uint32_t> sequence { 0 };
+        std::atomic<std::uintptr_t> words[NUM_WORDS] {}; // relaxed atomics: a lagging reader may copy them while reused
+    };
+
+public:
+    /** Returns a consistent copy of the published value (the default value until the first publication) */
+    T read() const noexcept
+    {
+        while (true) {
+            const Block* block = m_published.load(std::memory_order_acquire);
+            if (block == nullptr) {
+                return T();
+            }
+            const std::uint32_t sequence = block->sequence.load(std::memory_order_acquire);
+            std::uintptr_t words[NUM_WORDS];
+            for (std::size_t i = 0; i < NUM_WORDS; ++i) {
+                words[i] = block->words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ((sequence & 1) == 0 && block->sequence.load(std::memory_order_relaxed) == sequence) {
+                T value;
+                std::memcpy(&value, words, sizeof(T));
+                return value;
+            }
+        }
+    }
+
+    /** The value published last (writers only) */
+    const T& current() const noexcept { return m_current; }
+
+    void publish(const T& value) noexcept
+    {
+        m_current = value;
+        std::uintptr_t words[NUM_WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+        m_next = (m_next + 1) % NUM_BLOCKS;
+        Block& block = m_blocks[m_next];
+        const std::uint32_t sequence = block.sequence.load(std::memory_order_relaxed);
+        block.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < NUM_WORDS; ++i) {
+            block.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        block.sequence.store(sequence + 2, std::memory_order_release);
+        m_published.store(&block, std::memory_order_release);
+    }
+
+private:
+    Block m_blocks[NUM_BLOCKS];
+    std::atomic<const Block*> m_published { nullptr };
+    std::size_t m_next = 0;
+    T m_current {};
+};
+
+static PublishedValue<MemorySentinel::Config, 8> publishedConfig;
+static std::mutex configWriteMutex;
+static std::atomic<int> numArmedThreads { 0 }; // see MemorySentinel::setArmed()
+
+// The disarm override pushes numArmedThreads far below zero, so the hooks keep checking a single counter
+static constexpr int DISARM_OVERRIDE_BIAS = 1 << 30;
+static std::atomic<bool> isDisarmOverrideSet { false };
+
+/** The allocation quota consumed so far, packed as (quotaGeneration << 32 | consumedBytes) */
+static std::atomic<std::uint64_t> quotaLedger { 0 };
+
+template<class Mutator>
+static void updateConfig(Mutator mutate) noexcept
+{
+    std::lock_guard<std::mutex> lock(configWriteMutex);
+    MemorySentinel::Config next = publishedConfig.current();
+    mutate(next);
+    publishedConfig.publish(next);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Allowlist
+// Sorted, non-overlapping code address ranges whose allocations are not reported. Published like the configuration,
+// so the hooks only need a binary search on the return address instead of symbolizing it. Its size is published
+// separately, so that an empty allowlist costs the hooks a single load.
+struct AllowedRange
+{
+    std::uintptr_t begin = 0;
+    std::uintptr_t end = 0;
+};
+
+struct AllowList
+{
+    std::size_t count = 0;
+    AllowedRange ranges[MemorySentinel::MAX_ALLOWED_RANGES];
+};
+
+static PublishedValue<AllowList, 4> publishedAllowList; // rarely updated
+static std::atomic<std::size_t> allowListSize { 0 };
+
+/** Applies mutate to a copy of the allowlist, restores its invariants and publishes it */
+template<class Mutator>
+static bool updateAllowList(Mutator mutate) noexcept
+{
+    std::lock_guard<std::mutex> lock(configWriteMutex);
+    AllowList next = publishedAllowList.current();
+    if (!mutate(next)) {
+        return false;
+    }
+    std::sort(next.ranges, next.ranges + next.count,
+              [](const AllowedRange& a, const AllowedRange& b) { return a.begin < b.begin; });
+    std::size_t merged = 0;
+    for (std::size_t i = 0; i < next.count; ++i) {
+        if (merged > 0 && next.ranges[i].begin <= next.ranges[merged-1].end) {
+            next.ranges[merged-1].end = std::max(next.ranges[merged-1].end, next.ranges[i].end);
+        } else {
+            next.ranges[merged++] = next.ranges[i];
+        }
+    }
+    next.count = merged;
+    publishedAllowList.publish(next);
+    allowListSize.store(merged, std::memory_order_release);
+    return true;
+}
+
+static bool addAllowedRanges(const AllowedRange* ranges, std::size_t count) noexcept
+{
+    return updateAllowList([ranges, count](AllowList& list) {
+        if (count == 0 || list.count + count > MemorySentinel::MAX_ALLOWED_RANGES) {
+            return false;
+        }
+        std::copy(ranges, ranges + count, list.ranges + list.count);
+        list.count += count;
+        return true;
+    });
+}
+
+static std::uint32_t consumedQuota(const MemorySentinel::Config& config, std::uint64_t ledger) noexcept
+{
+    // consumption recorded under an older quota does not count against the current one
+    return (static_cast<std::uint32_t>(ledger >> 32) == config.quotaGeneration) ? static_cast<std::uint32_t>(ledger) : 0;
+}
+
+static thread_local int samplingCountdown = 0; // counts down to the next sampled allocation/deallocation
+static thread_local MemorySentinel::ThreadCounters threadCounters; // see MemorySentinel::getThreadCounters()
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Hooks
+// Only compiled if enabled by the policy (see MemorySentinelPolicy), so that the allocation functions are not
+// replaced at all in builds without the sentinel.
+#if SLB_MEMORY_SENTINEL_ENABLED
+
+// Keep the replacement functions even if nothing references them (e.g. with LTO) and export them from shared objects
+#if defined(__clang__) || defined(__GNUC__)
+    #define SLB_REPLACEMENT_FUNCTION __attribute__((used, visibility("default")))
+#else
+    #define SLB_REPLACEMENT_FUNCTION
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Redirect arenas
+// Process-wide registry of the arenas of redirecting scopes, so that delete recognizes their blocks on any thread.
+// A slot is claimed by a CAS on its end, then published with its begin; it is released in the reverse order.
+// Lookups re-read the begin to detect a slot that was released and claimed again in the meantime.
+struct RedirectArenaSlot
+{
+    std::atomic<std::uintptr_t> begin { 0 };
+    std::atomic<std::uintptr_t> end { 0 };
+};
+
+static RedirectArenaSlot redirectArenaSlots[MemorySentinel::MAX_REDIRECT_ARENAS];
+static std::atomic<int> numRedirectArenas { 0 };
+
+static int registerRedirectArena(std::uintptr_t begin, std::uintptr_t end) noexcept
+{
+    for (std::size_t slot = 0; slot < MemorySentinel::MAX_REDIRECT_ARENAS; ++slot) {
+        std::uintptr_t expected = 0;
+        if (redirectArenaSlots[slot].end.compare_exchange_strong(expected, end)) {
+            redirectArenaSlots[slot].begin.store(begin);
+            numRedirectArenas.fetch_add(1);
+            return static_cast<int>(slot);
+        }
+    }
+    return -1;
+}
+
+static void unregisterRedirectArena(int slot) noexcept
+{
+    numRedirectArenas.fetch_sub(1);
+    redirectArenaSlots[slot].begin.store(0);
+    redirectArenaSlots[slot].end.store(0);
+}
+
+static bool isRedirectArenaBlock(const void* ptr) noexcept
+{
+    if (numRedirectArenas.load(std::memory_order_relaxed) == 0 || ptr == nullptr) {
+        return false;
+    }
+    const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+    for (const RedirectArenaSlot& slot : redirectArenaSlots) {
+        const std::uintptr_t begin = slot.begin.load();
+        if (begin == 0 || address < begin) {
+            continue;
+        }
+        const std::uintptr_t end = slot.end.load();
+        if (address < end && slot.begin.load() == begin) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Next block of a scope's arena, aligned for any type (nullptr if size does not fit) */
+static char* nextArenaBlock(const MemorySentinel::Scope& scope, std::size_t size) noexcept
+{
+    constexpr std::uintptr_t alignment = alignof(std::max_align_t);
+    const std::uintptr_t cursor = (reinterpret_cast<std::uintptr_t>(scope.arenaCursor) + alignment - 1) & ~(alignment - 1);
+    const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(scope.arenaEnd);
+    size = size > 0 ? size : 1; // distinct blocks for 0-byte requests
+    if (scope.arenaBegin == nullptr || cursor > end || size > end - cursor) {
+        return nullptr;
+    }
+    return reinterpret_cast<char*>(cursor);
+}
+
+/** Usable size of a block allocated with the platform malloc or the fallback pool (0 if not supported) */
+static std::size_t usableSize(void* ptr) noexcept
+{
+    if (ptr == nullptr) {
+        return 0;
+    }
+    if (MemorySentinelPool::owns(ptr)) {
+        return MemorySentinelPool::blockSize(ptr);
+    }
+#if defined(__GLIBC__)
+    return malloc_usable_size(ptr);
+#elif defined(__APPLE__)
+    return malloc_size(ptr);
+#elif defined(_MSC_VER)
+    return _msize(ptr);
+#else
+    return 0;
+#endif
+}
+
+/** Atomically deducts size from the quota of the given configuration. Returns false if it does not fit. */
+static bool consumeQuota(const MemorySentinel::Config& config, std::size_t size, int& remainingQuota) noexcept
+{
+    std::uint64_t ledger = quotaLedger.load(std::memory_order_relaxed);
+    while (true) {
+        const std::uint32_t consumed = consumedQuota(config, ledger);
+        const long long available = static_cast<long long>(config.allocationQuota) - consumed;
+        if (available <= 0 || static_cast<long long>(size) > available) {
+            return false;
+        }
+        const std::uint64_t updated = (static_cast<std::uint64_t>(config.quotaGeneration) << 32) | (consumed + size);
+        if (quotaLedger.compare_exchange_weak(ledger, updated, std::memory_order_relaxed)) {
+            remainingQuota = static_cast<int>(available - static_cast<long long>(size));
+            return true;
+        }
+    }
+}
 
 #if defined(__clang__) || defined(__GNUC__)
 __attribute__((noreturn)) 
@@ -32,26 +330,97 @@ static void handleTransgressionException() noexcept(false)
 #endif
 }
 
+/** True if the return address of an allocation function lies within an allowlisted range */
+static bool isAllowedCaller(const void* returnAddress) noexcept
+{
+    const auto address = reinterpret_cast<std::uintptr_t>(returnAddress);
+    if (address == 0 || allowListSize.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    const AllowList list = publishedAllowList.read();
+    const AllowedRange* end = list.ranges + list.count;
+    const AllowedRange* next = std::upper_bound(list.ranges, end, address,
+                                                [](std::uintptr_t value, const AllowedRange& range) { return value < range.begin; });
+    return next != list.ranges && address < (next-1)->end;
+}
+
+static bool consumeScopeQuota(MemorySentinel::Scope& scope, std::size_t size, int& remainingQuota) noexcept
+{
+    if (scope.remainingQuota <= 0 || size > static_cast<std::size_t>(scope.remainingQuota)) {
+        return false;
+    }
+    scope.remainingQuota -= static_cast<int>(size);
+    remainingQuota = scope.remainingQuota;
+    return true;
+}
+
+/** Outcome of an allocation/deallocation while armed */
+enum class Verdict
+{
+    EXEMPT,         ///< ScopedAllowAllocation or allowlisted caller
+    PERMITTED,      ///< within the quota
+    REDIRECTED,     ///< reported, to be served by the arena of the current scope
+    TRANSGRESSION   ///< reported (unless the exception handler threw)
+};
+
 template<class ExceptionHandler>
-static bool handleTransgression(const char* optionalMsg, std::size_t size, ExceptionHandler exceptionHandler)
+static Verdict handleTransgression(const MemorySentinel::Config& config, const char* optionalMsg, std::size_t size,
+                                const void* returnAddress, ExceptionHandler exceptionHandler)
 {
-    assert(MemorySentinel::getInstance().isArmed());
+    // The innermost scope of this thread (if any) overrides the global quota and behaviour
+    MemorySentinel& sentinel = MemorySentinel::getInstance();
+    MemorySentinel::Scope* scope = sentinel.getCurrentScope();
     
-    int availableQuota = MemorySentinel::getRemainingAllocationQuota();
-    if (availableQuota > 0 && size <= availableQuota) {
-        MemorySentinel::setAllocationQuota(availableQuota - static_cast<int>(size));
-        printf("[MemorySentinel]: permitted allocation in %s - %zu Bytes quota remaining\n",
-               optionalMsg, static_cast<std::size_t>(MemorySentinel::getRemainingAllocationQuota()));
-        return true; // this allocation was allowed
+    if (sentinel.isAllocationAllowed() || isAllowedCaller(returnAddress)) {
+        if (size > 0) {
+            if (MemorySentinelActivePolicy::statistics) {
+                MemorySentinelStatistics::recordExemptAllocation();
+            }
+            if (scope != nullptr) {
+                scope->exemptAllocations++;
+            }
+        }
+        return Verdict::EXEMPT; // neither reported nor charged to the quota
+    }
+    if (scope != nullptr && size > 0) {
+        scope->allocations++;
+        scope->allocatedBytes += size;
+        if (MemorySentinelActivePolicy::statistics && scope->tagIndex >= 0) {
+            MemorySentinelStatistics::recordTagAllocation(scope->tagIndex, size);
+        }
+    }
+    
+    const MemorySentinel::TransgressionBehaviour behaviour = scope != nullptr ? scope->transgressionBehaviour
+                                                                              : config.transgressionBehaviour;
+    int remainingQuota = 0;
+    if (scope != nullptr ? consumeScopeQuota(*scope, size, remainingQuota) : consumeQuota(config, size, remainingQuota)) {
+        if (MemorySentinelActivePolicy::statistics) {
+            MemorySentinelStatistics::recordPermittedAllocation();
+        }
+        // only logged with LOG, and not while the fallback pool serves them in deterministic time (stdio may lock)
+        if (behaviour == MemorySentinel::TransgressionBehaviour::LOG && !config.fallbackPoolUsed) {
+            printf("[MemorySentinel]: permitted allocation in %s - %zu Bytes quota remaining\n",
+                   optionalMsg, static_cast<std::size_t>(remainingQuota));
+        }
+        return Verdict::PERMITTED;
     }
 
-    MemorySentinel::getInstance().registerTransgression();
+    sentinel.registerTransgression();
+    if (MemorySentinelActivePolicy::statistics) {
+        MemorySentinelStatistics::recordTransgression();
+    }
+    if (scope != nullptr) {
+        scope->transgressions++;
+        if (MemorySentinelActivePolicy::statistics && scope->tagIndex >= 0) {
+            MemorySentinelStatistics::recordTagTransgression(scope->tagIndex);
+        }
+    }
     
-    switch (MemorySentinel::getTransgressionBehaviour())
+    switch (behaviour)
     {
         case MemorySentinel::TransgressionBehaviour::THROW_EXCEPTION: {
             exceptionHandler();
-            return false;
+            return Verdict::TRANSGRESSION;
         }
         case MemorySentinel::TransgressionBehaviour::LOG: {
             if (size !=0) {
@@ -59,36 +428,126 @@ static bool handleTransgression(const char* optionalMsg, std::size_t size, Excep
             } else {
                 printf("[MemorySentinel]: !!Transgression detected!! %s \n", optionalMsg);
             }
-            return false;
+            return Verdict::TRANSGRESSION;
         }
         case MemorySentinel::TransgressionBehaviour::SILENT: {
-            return false;
+            return Verdict::TRANSGRESSION;
+        }
+        case MemorySentinel::TransgressionBehaviour::REDIRECT: {
+            if (size == 0) {
+                return Verdict::TRANSGRESSION; // deallocation
+            }
+            if (scope == nullptr || nextArenaBlock(*scope, size) == nullptr) {
+                exceptionHandler(); // no arena or exhausted: the allocation is bounded
+                return Verdict::TRANSGRESSION;
+            }
+            return Verdict::REDIRECTED;
         }
     }
     
-    return false;
+    return Verdict::TRANSGRESSION;
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Hijack
 // Using pattern described here: https://stackoverflow.com/a/17850402/649700
-static bool isHijackActive = false;
+// The hijack is suspended per thread while the transgression handler / statistics run, so that allocations made by
+// the sentinel itself (e.g. printf) are not intercepted. Other threads remain monitored.
+static thread_local bool isHijackSuspended = false;
+
+class ScopedHijackSuspension
+{
+public:
+    ScopedHijackSuspension() noexcept { isHijackSuspended = true; }
+    ~ScopedHijackSuspension() { isHijackSuspended = false; }
+    ScopedHijackSuspension(const ScopedHijackSuspension&) = delete;
+    ScopedHijackSuspension& operator= (const ScopedHijackSuspension&) = delete;
+};
+
+/** True while any thread is armed (see MemorySentinel::setArmed) and the hijack is not suspended on this thread */
+static bool isHijacking() noexcept
+{
+    return numArmedThreads.load(std::memory_order_relaxed) > 0 && !isHijackSuspended;
+}
 
 /** exception-throwing variant */
-static decltype(auto) hijack(const char* msg, std::size_t size = 0) noexcept(false)
+static decltype(auto) hijack(const MemorySentinel::Config& config, const char* msg, std::size_t size,
+                             const void* returnAddress) noexcept(false)
 {
-    // Disabling 'hijack' while running 'trangression handler'
-    isHijackActive = false;
-    auto retValue = handleTransgression(msg, size, handleTransgressionException);
-    isHijackActive = true;
-    return retValue;
+    // Disabling 'hijack' while running 'trangression handler' (also when it throws)
+    ScopedHijackSuspension suspension;
+    return handleTransgression(config, msg, size, returnAddress, handleTransgressionException);
 }
 /** no-except variant */
-static decltype(auto) hijack(const char* msg, std::size_t size, std::nothrow_t const&) noexcept(true)
+static decltype(auto) hijack(const MemorySentinel::Config& config, const char* msg, std::size_t size,
+                             const void* returnAddress, std::nothrow_t const&) noexcept(true)
 {
     // Disabling 'hijack' while running 'trangression handler'
-    isHijackActive = false;
-    auto retValue = handleTransgression(msg, size, [](){ return false; }); // dummy transgression handler simply return false in case an exception occurs
-    isHijackActive = true;
-    return retValue;
+    ScopedHijackSuspension suspension;
+    return handleTransgression(config, msg, size, returnAddress, [](){ return false; }); // dummy transgression handler simply return false in case an exception occurs
+}
+
+static bool isSampled(const MemorySentinel::Config& config) noexcept
+{
+    if (!MemorySentinelActivePolicy::statistics || !config.statisticsEnabled || isHijackSuspended) {
+        return false;
+    }
+    if (--samplingCountdown > 0) {
+        return false;
+    }
+    samplingCountdown = config.samplingInterval;
+    return true;
+}
+
+static bool isTrackingLiveAllocations(const MemorySentinel::Config& config) noexcept
+{
+    return MemorySentinelActivePolicy::statistics && config.liveAllocationsTracked && !isHijackSuspended;
+}
+
+static constexpr std::size_t PLATFORM_BLOCK_SIZE = ~static_cast<std::size_t>(0); // ask the platform allocator
+
+static void recordLiveAllocation(void* ptr, std::size_t size, const void* returnAddress) noexcept
+{
+    ScopedHijackSuspension suspension; // capturing the stack may allocate
+    const MemorySentinel::Scope* scope = MemorySentinel::getInstance().getCurrentScope();
+    MemorySentinelLiveAllocations::recordAllocation(ptr, size, returnAddress, scope != nullptr ? scope->tagIndex : -1);
+}
+
+/** @param blockSize usable size of the block, if not allocated by the platform allocator */
+static void* recordAllocation(const MemorySentinel::Config& config, void* ptr, std::size_t size, const void* returnAddress,
+                              std::size_t blockSize = PLATFORM_BLOCK_SIZE) noexcept
+{
+    if (MemorySentinelActivePolicy::statistics && ptr != nullptr && !isHijackSuspended) {
+        threadCounters.allocations++;
+        threadCounters.allocatedBytes += size;
+    }
+    if (ptr != nullptr && isSampled(config)) {
+        const void* callSite = MemorySentinelActivePolicy::callSites ? returnAddress : nullptr;
+        MemorySentinelStatistics::recordAllocation(size, blockSize == PLATFORM_BLOCK_SIZE ? usableSize(ptr) : blockSize, callSite);
+    }
+    if (ptr != nullptr && isTrackingLiveAllocations(config)) {
+        recordLiveAllocation(ptr, size, returnAddress);
+    }
+    return ptr;
+}
+
+/** The counters of recordDeallocation(), without the live allocations */
+static void countDeallocation(const MemorySentinel::Config& config, void* ptr, std::size_t blockSize) noexcept
+{
+    if (MemorySentinelActivePolicy::statistics && ptr != nullptr && !isHijackSuspended) {
+        threadCounters.deallocations++;
+    }
+    if (ptr != nullptr && isSampled(config)) {
+        MemorySentinelStatistics::recordDeallocation(blockSize == PLATFORM_BLOCK_SIZE ? usableSize(ptr) : blockSize);
+    }
+}
+
+static void recordDeallocation(const MemorySentinel::Config& config, void* ptr, std::size_t blockSize = PLATFORM_BLOCK_SIZE) noexcept
+{
+    countDeallocation(config, ptr, blockSize);
+    if (ptr != nullptr && isTrackingLiveAllocations(config)) {
+        MemorySentinelLiveAllocations::recordDeallocation(ptr);
+    }
 }
 
 
@@ -127,137 +586,312 @@ static void initMallocHijack()
     }
 }
 
-void* malloc(size_t size)
+SLB_REPLACEMENT_FUNCTION void* malloc(size_t size)
 {
     if (builtinMalloc == nullptr) {
         initMallocHijack();
     }
-    if (isHijackActive) {
-        hijack("allocation with malloc", size);
+    const auto config = publishedConfig.read();
+    if (isHijacking()) {
+        hijack(config, "allocation with malloc", size, SLB_RETURN_ADDRESS());
     }
-    return builtinMalloc(size);
+    return recordAllocation(config, builtinMalloc(size), size, SLB_RETURN_ADDRESS());
 }
 
-void* calloc(size_t num, size_t size)
+SLB_REPLACEMENT_FUNCTION void* calloc(size_t num, size_t size)
 {
     if (builtinCalloc == nullptr) {
         initMallocHijack();
     }
-    if (isHijackActive) {
-        hijack("allocation with calloc", size);
+    const auto config = publishedConfig.read();
+    if (isHijacking()) {
+        hijack(config, "allocation with calloc", size, SLB_RETURN_ADDRESS());
     }
-    return builtinCalloc(num, size);
+    return recordAllocation(config, builtinCalloc(num, size), num * size, SLB_RETURN_ADDRESS());
+}
+
+static bool isRecordingReallocations(const MemorySentinel::Config& config) noexcept
+{
+    // not sampled: a chain is only visible if each of its reallocs is seen
+    return MemorySentinelActivePolicy::statistics && MemorySentinelActivePolicy::callSites
+           && config.statisticsEnabled && !isHijackSuspended;
 }
 
-void* realloc(void* ptr, size_t size)
+/** Old size of a block about to be reallocated: the requested size if tracked, else the usable size */
+static std::size_t reallocatedBlockSize(const MemorySentinel::Config& config, void* ptr) noexcept
+{
+    const std::size_t trackedSize = isTrackingLiveAllocations(config) ? MemorySentinelLiveAllocations::findSize(ptr) : 0;
+    return trackedSize != 0 ? trackedSize : usableSize(ptr);
+}
+
+SLB_REPLACEMENT_FUNCTION void* realloc(void* ptr, size_t size)
 {
     if (builtinRealloc == nullptr) {
         initMallocHijack();
     }
-    if (isHijackActive) {
-        hijack("allocation with realloc", size);
+    const auto config = publishedConfig.read();
+    if (isHijacking()) {
+        hijack(config, "allocation with realloc", size, SLB_RETURN_ADDRESS());
+    }
+    const bool isRecording = ptr != nullptr && isRecordingReallocations(config);
+    const std::size_t oldSize = isRecording ? reallocatedBlockSize(config, ptr) : 0;
+    const std::size_t oldBlockSize = config.statisticsEnabled ? usableSize(ptr) : 0; // while the block is still ours
+    // the block leaves the live table before realloc may free it (and another thread reuse its address)
+    const std::size_t liveSize = ptr != nullptr && isTrackingLiveAllocations(config) ? MemorySentinelLiveAllocations::findSize(ptr) : 0;
+    if (liveSize != 0) {
+        MemorySentinelLiveAllocations::recordDeallocation(ptr);
+    }
+    void* result = builtinRealloc(ptr, size);
+    if (result == nullptr && size != 0) {
+        if (liveSize != 0) {
+            recordLiveAllocation(ptr, liveSize, SLB_RETURN_ADDRESS()); // failed: the original block is still live
+        }
+        return nullptr;
+    }
+    countDeallocation(config, ptr, oldBlockSize);
+    if (isRecording && result != nullptr) {
+        MemorySentinelStatistics::recordReallocation(ptr, oldSize, result, size, SLB_RETURN_ADDRESS());
     }
-    return builtinRealloc(ptr, size);
+    return recordAllocation(config, result, size, SLB_RETURN_ADDRESS());
 }
 
-void free(void* ptr)
+SLB_REPLACEMENT_FUNCTION void free(void* ptr)
 {
     if (builtinFree == nullptr) {
         initMallocHijack();
     }
-    if (isHijackActive) {
+    const auto config = publishedConfig.read();
+    if (isHijacking()) {
         std::nothrow_t nt; // force non-throwing overload with tag
-        hijack("deallocation with free", 0, nt);
+        hijack(config, "deallocation with free", 0, SLB_RETURN_ADDRESS(), nt);
+    }
+    recordDeallocation(config, ptr);
+    builtinFree(ptr);
+}
+
+static void* unhookedMalloc(size_t size)
+{
+    if (builtinMalloc == nullptr) {
+        initMallocHijack();
+    }
+    return builtinMalloc(size);
+}
+
+static void unhookedFree(void* ptr)
+{
+    if (builtinFree == nullptr) {
+        initMallocHijack();
     }
     builtinFree(ptr);
 }
 
 #else // ifdef GNU/Clang
 // Define these for Microsoft Compiler and GCC without GLIB, as they're used in new/delete overrides
-void* builtinMalloc(size_t size)
+static void* unhookedMalloc(size_t size)
 {
     return std::malloc(size);
 }
-void builtinFree(void* ptr)
+static void unhookedFree(void* ptr)
 {
-    return std::free(ptr);
+    std::free(ptr);
 }
 #endif
 
+/** Bumps the arena of the current scope (checked by handleTransgression). The block is not recorded in the statistics. */
+static void* redirectAllocation(std::size_t size) noexcept
+{
+    MemorySentinel::Scope& scope = *MemorySentinel::getInstance().getCurrentScope();
+    char* block = nextArenaBlock(scope, size);
+    scope.arenaCursor = block + (size > 0 ? size : 1);
+    scope.redirectedAllocations++;
+    return block;
+}
+
+/** Quota-permitted allocations are served by the fallback pool (if enabled and not exhausted) */
+static void* allocateBlock(const MemorySentinel::Config& config, Verdict verdict, std::size_t size) noexcept
+{
+    if (verdict == Verdict::PERMITTED && config.fallbackPoolUsed) {
+        void* block = MemorySentinelPool::allocate(size);
+        if (block != nullptr) {
+            return block;
+        }
+    }
+    return unhookedMalloc(size);
+}
+
+static void freeBlock(void* ptr) noexcept
+{
+    if (MemorySentinelPool::owns(ptr)) {
+        MemorySentinelPool::deallocate(ptr);
+    } else {
+        unhookedFree(ptr);
+    }
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // MARK: - new
-void* operator new(std::size_t size) noexcept(false)
+SLB_REPLACEMENT_FUNCTION void* operator new(std::size_t size) noexcept(false)
 {
-    if (isHijackActive) {
-        hijack("allocation with new", size);
-        return builtinMalloc(size); // allocate the memory with the 'un-hijacked' malloc.
+    const auto config = publishedConfig.read();
+    if (isHijacking()) {
+        const Verdict verdict = hijack(config, "allocation with new", size, SLB_RETURN_ADDRESS());
+        if (verdict == Verdict::REDIRECTED) {
+            return redirectAllocation(size);
+        }
+        // allocate the memory with the 'un-hijacked' malloc (or the fallback pool).
+        return recordAllocation(config, allocateBlock(config, verdict, size), size, SLB_RETURN_ADDRESS());
     }
     if (size == 0) { // Handle 0-byte requests by treating them as 1-byte requests
       size = 1;
     }
-    return std::malloc(size);
+    return recordAllocation(config, unhookedMalloc(size), size, SLB_RETURN_ADDRESS());
 }
 
 // MARK: - new[]
-void* operator new[](std::size_t size) noexcept(false)
+SLB_REPLACEMENT_FUNCTION void* operator new[](std::size_t size) noexcept(false)
 {
-    if (isHijackActive) {
-        hijack("allocation with new[]", size);
-        return builtinMalloc(size); // allocate the memory with the 'un-hijacked' malloc.
+    const auto config = publishedConfig.read();
+    if (isHijacking()) {
+        const Verdict verdict = hijack(config, "allocation with new[]", size, SLB_RETURN_ADDRESS());
+        if (verdict == Verdict::REDIRECTED) {
+            return redirectAllocation(size);
+        }
+        // allocate the memory with the 'un-hijacked' malloc (or the fallback pool).
+        return recordAllocation(config, allocateBlock(config, verdict, size), size, SLB_RETURN_ADDRESS());
     }
-    return std::malloc(size);
+    return recordAllocation(config, unhookedMalloc(size), size, SLB_RETURN_ADDRESS());
 }
 
 // MARK: - new noexcept
-void* operator new(std::size_t size, std::nothrow_t const& nt) noexcept(true)
+SLB_REPLACEMENT_FUNCTION void* operator new(std::size_t size, std::nothrow_t const& nt) noexcept(true)
 {
-    if (isHijackActive) {
-        hijack("allocation with new (nothrow)", size, nt); // will always return false
-        return nullptr; // convention
+    const auto config = publishedConfig.read();
+    if (isHijacking()) {
+        const Verdict verdict = hijack(config, "allocation with new (nothrow)", size, SLB_RETURN_ADDRESS(), nt);
+        if (verdict == Verdict::TRANSGRESSION) {
+            return nullptr; // convention
+        }
+        if (verdict == Verdict::REDIRECTED) {
+            return redirectAllocation(size);
+        }
+        return recordAllocation(config, allocateBlock(config, verdict, size), size, SLB_RETURN_ADDRESS());
     }
-    return std::malloc(size);
+    return recordAllocation(config, unhookedMalloc(size), size, SLB_RETURN_ADDRESS());
 }
 
 // MARK: - new[] noexcept
-void* operator new[](std::size_t size, std::nothrow_t const& nt) noexcept(true)
+SLB_REPLACEMENT_FUNCTION void* operator new[](std::size_t size, std::nothrow_t const& nt) noexcept(true)
 {
-    if (isHijackActive) {
-        hijack("allocation with new[] (nothrow)", size, nt); // will always return false
-        return nullptr; // convention
+    const auto config = publishedConfig.read();
+    if (isHijacking()) {
+        const Verdict verdict = hijack(config, "allocation with new[] (nothrow)", size, SLB_RETURN_ADDRESS(), nt);
+        if (verdict == Verdict::TRANSGRESSION) {
+            return nullptr; // convention
+        }
+        if (verdict == Verdict::REDIRECTED) {
+            return redirectAllocation(size);
+        }
+        return recordAllocation(config, allocateBlock(config, verdict, size), size, SLB_RETURN_ADDRESS());
     }
-    return std::malloc(size);
+    return recordAllocation(config, unhookedMalloc(size), size, SLB_RETURN_ADDRESS());
 }
 
 // MARK: - delete -- always noexcept
-void operator delete(void* ptr) noexcept(true)
+SLB_REPLACEMENT_FUNCTION void operator delete(void* ptr) noexcept(true)
 {
-    if (isHijackActive) {
+    if (isRedirectArenaBlock(ptr)) {
+        return; // released with the arena's scope
+    }
+    const auto config = publishedConfig.read();
+    if (isHijacking()) {
         std::nothrow_t nt; // force non-throwing overload with tag
-        hijack("deallocation with delete", 0, nt);
-        builtinFree(ptr); // free the memory with the 'un-hijacked' free.
-    } else {
-        std::free(ptr);
+        hijack(config, "deallocation with delete", 0, SLB_RETURN_ADDRESS(), nt);
     }
+    recordDeallocation(config, ptr);
+    freeBlock(ptr); // free the memory with the 'un-hijacked' free (or return it to the fallback pool).
 }
 
 // MARK: - delete[]  -- always noexcept
-void operator delete[](void* ptr) noexcept(true)
+SLB_REPLACEMENT_FUNCTION void operator delete[](void* ptr) noexcept(true)
 {
-    if (isHijackActive) {
+    if (isRedirectArenaBlock(ptr)) {
+        return; // released with the arena's scope
+    }
+    const auto config = publishedConfig.read();
+    if (isHijacking()) {
         std::nothrow_t nt; // force non-throwing overload with tag
-        hijack("deallocation with delete[]", 0, nt);
-        builtinFree(ptr); // free the memory with the 'un-hijacked' free.
-    } else {
-        std::free(ptr);
+        hijack(config, "deallocation with delete[]", 0, SLB_RETURN_ADDRESS(), nt);
     }
+    recordDeallocation(config, ptr);
+    freeBlock(ptr); // free the memory with the 'un-hijacked' free (or return it to the fallback pool).
+}
+
+#endif // SLB_MEMORY_SENTINEL_ENABLED
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Monitored allocators
+int MemorySentinel::internTag(const char* label, const char* qualifier) noexcept
+{
+    return MemorySentinelActivePolicy::statistics ? MemorySentinelStatistics::internTag(label, qualifier) : -1;
+}
+
+void* MemorySentinel::allocateMonitored(std::size_t size, std::size_t alignment, const void* callSite,
+                                        UpstreamAllocate allocate, void* upstream, int tagIndex)
+{
+#if SLB_MEMORY_SENTINEL_ENABLED
+    const auto config = publishedConfig.read();
+    if (isHijacking()) {
+        const Verdict verdict = hijack(config, "allocation with memory resource", size, callSite);
+        if (verdict == Verdict::REDIRECTED && alignment <= alignof(std::max_align_t)) {
+            return redirectAllocation(size);
+        }
+    }
+    void* ptr = nullptr;
+    {
+        ScopedHijackSuspension suspension; // accounted here, not in the hooks (if upstream uses the heap)
+        ptr = allocate(upstream, size, alignment);
+    }
+    if (MemorySentinelActivePolicy::statistics && config.statisticsEnabled && tagIndex >= 0 && ptr != nullptr) {
+        MemorySentinelStatistics::recordTagAllocation(tagIndex, size);
+    }
+    return recordAllocation(config, ptr, size, callSite, size);
+#else
+    (void) callSite;
+    (void) tagIndex;
+    return allocate(upstream, size, alignment);
+#endif
+}
+
+void MemorySentinel::deallocateMonitored(void* ptr, std::size_t size, std::size_t alignment, const void* callSite,
+                                         UpstreamDeallocate deallocate, void* upstream)
+{
+#if SLB_MEMORY_SENTINEL_ENABLED
+    if (isRedirectArenaBlock(ptr)) {
+        return; // released with the arena's scope
+    }
+    const auto config = publishedConfig.read();
+    if (isHijacking()) {
+        std::nothrow_t nt; // force non-throwing overload with tag
+        hijack(config, "deallocation with memory resource", 0, callSite, nt);
+    }
+    recordDeallocation(config, ptr, size);
+    ScopedHijackSuspension suspension;
+    deallocate(upstream, ptr, size, alignment);
+#else
+    (void) callSite;
+    deallocate(upstream, ptr, size, alignment);
+#endif
 }
 
 // --------------------------------------------------------------------------------------------------------------------
 // MARK: - MemorySentinel
 
-// initialization (static non-const must be initialized out out line
-std::atomic<MemorySentinel::TransgressionBehaviour> MemorySentinel::m_transgressionBehaviour(TransgressionBehaviour::LOG);
-std::atomic<int> MemorySentinel::m_allocationQuota(0);
+constexpr int MemorySentinel::MAX_SCOPE_DEPTH;
+constexpr std::size_t MemorySentinel::MAX_ALLOWED_RANGES;
+constexpr std::size_t MemorySentinel::MAX_REDIRECT_ARENAS;
+constexpr std::size_t MemorySentinel::NUM_LIFETIME_BUCKETS;
+constexpr std::size_t MemorySentinel::NUM_SIZE_CLASSES;
+constexpr std::size_t MemorySentinel::DEFAULT_FALLBACK_POOL_BYTES;
 
 MemorySentinel& MemorySentinel::getInstance() noexcept
 {
@@ -265,10 +899,71 @@ MemorySentinel& MemorySentinel::getInstance() noexcept
     return instance;
 }
 
+MemorySentinel::Config MemorySentinel::getConfig() noexcept
+{
+    Config config = publishedConfig.read();
+    config.hijackActive = numArmedThreads.load() > 0;
+    return config;
+}
+
 void MemorySentinel::setArmed(bool value) noexcept
 {
-    m_allocationForbidden.store(value);
-    isHijackActive = value;
+    // each thread holds one reference while armed, so no thread can disarm another
+    if (m_allocationForbidden.exchange(value) != value) {
+        numArmedThreads.fetch_add(value ? 1 : -1);
+    }
+}
+
+void MemorySentinel::setDisarmOverride(bool value) noexcept
+{
+    if (isDisarmOverrideSet.exchange(value) != value) {
+        numArmedThreads.fetch_add(value ? -DISARM_OVERRIDE_BIAS : DISARM_OVERRIDE_BIAS);
+    }
+}
+
+bool MemorySentinel::isDisarmOverridden() noexcept
+{
+    return isDisarmOverrideSet.load();
+}
+
+void MemorySentinel::setTransgressionBehaviour(TransgressionBehaviour b) noexcept
+{
+    if (Scope* scope = getInstance().getCurrentScope()) {
+        scope->transgressionBehaviour = b;
+        return;
+    }
+    updateConfig([b](Config& config) { config.transgressionBehaviour = b; });
+}
+
+MemorySentinel::TransgressionBehaviour MemorySentinel::getTransgressionBehaviour() noexcept
+{
+    if (const Scope* scope = getInstance().getCurrentScope()) {
+        return scope->transgressionBehaviour;
+    }
+    return getConfig().transgressionBehaviour;
+}
+
+void MemorySentinel::setAllocationQuota(int numBytes) noexcept
+{
+    if (Scope* scope = getInstance().getCurrentScope()) {
+        scope->remainingQuota = numBytes;
+        return;
+    }
+    // a new quota generation starts with nothing consumed
+    updateConfig([numBytes](Config& config) {
+        config.allocationQuota = numBytes;
+        ++config.quotaGeneration;
+    });
+}
+
+int MemorySentinel::getRemainingAllocationQuota() noexcept
+{
+    if (const Scope* scope = getInstance().getCurrentScope()) {
+        return scope->remainingQuota;
+    }
+    const Config config = getConfig();
+    const long long remaining = static_cast<long long>(config.allocationQuota) - consumedQuota(config, quotaLedger.load());
+    return remaining > 0 ? static_cast<int>(remaining) : 0;
 }
 
 bool MemorySentinel::getAndClearTransgressionsOccured() noexcept
@@ -277,3 +972,348 @@ bool MemorySentinel::getAndClearTransgressionsOccured() noexcept
     clearTransgressions();
     return result;
 }
+
+void MemorySentinel::setStatisticsEnabled(bool value) noexcept
+{
+    updateConfig([value](Config& config) { config.statisticsEnabled = value; });
+}
+
+void MemorySentinel::setSamplingInterval(int interval) noexcept
+{
+    interval = interval < 1 ? 1 : interval;
+    updateConfig([interval](Config& config) { config.samplingInterval = interval; });
+    samplingCountdown = 0;
+}
+
+MemorySentinel::Statistics MemorySentinel::getStatistics() noexcept
+{
+    return MemorySentinelStatistics::read();
+}
+
+void MemorySentinel::resetStatistics() noexcept
+{
+    MemorySentinelStatistics::reset();
+    MemorySentinelLiveAllocations::resetLifetimeHistograms();
+}
+
+MemorySentinel::ThreadCounters MemorySentinel::getThreadCounters() noexcept
+{
+    return threadCounters;
+}
+
+std::size_t MemorySentinel::getTopCallSites(CallSite* result, std::size_t maxCount) noexcept
+{
+    return MemorySentinelStatistics::readTopCallSites(result, maxCount);
+}
+
+bool MemorySentinel::setLiveAllocationTrackingEnabled(bool value) noexcept
+{
+    if (value && !MemorySentinelLiveAllocations::initialize()) {
+        return false;
+    }
+    updateConfig([value](Config& config) { config.liveAllocationsTracked = value; });
+    return true;
+}
+
+bool MemorySentinel::setFallbackPoolEnabled(bool value, std::size_t bytesPerSizeClass) noexcept
+{
+    if (value && !MemorySentinelPool::initialize(bytesPerSizeClass)) {
+        return false;
+    }
+    updateConfig([value](Config& config) { config.fallbackPoolUsed = value; });
+    return true;
+}
+
+MemorySentinel::FallbackPoolStatistics MemorySentinel::getFallbackPoolStatistics() noexcept
+{
+    return MemorySentinelPool::read();
+}
+
+std::size_t MemorySentinel::writeLeakReport(int fileDescriptor, const char* scopeTag) noexcept
+{
+    const int tagIndex = scopeTag != nullptr ? MemorySentinelStatistics::internTag(scopeTag) : -1;
+    if (scopeTag != nullptr && tagIndex < 0) {
+        return 0;
+    }
+    return MemorySentinelLiveAllocations::writeLeakReport(fileDescriptor, tagIndex);
+}
+
+bool MemorySentinel::setLeakReportAtExit(const char* path, const char* scopeTag) noexcept
+{
+    const int tagIndex = scopeTag != nullptr ? MemorySentinelStatistics::internTag(scopeTag) : -1;
+    if (scopeTag != nullptr && tagIndex < 0) {
+        return false;
+    }
+    return MemorySentinelLiveAllocations::writeLeakReportAtExit(path, tagIndex) && setLiveAllocationTrackingEnabled(true);
+}
+
+std::size_t MemorySentinel::getTopReallocSites(ReallocSite* result, std::size_t maxCount) noexcept
+{
+    return MemorySentinelStatistics::readTopReallocSites(result, maxCount);
+}
+
+std::size_t MemorySentinel::getSizeHistogram(SizeClass* result, std::size_t maxCount) noexcept
+{
+    return MemorySentinelStatistics::readSizeHistogram(result, maxCount);
+}
+
+std::size_t MemorySentinel::suggestSizeClasses(SizeClass* result, std::size_t maxCount, double coverage) noexcept
+{
+    return MemorySentinelStatistics::suggestSizeClasses(result, maxCount, coverage);
+}
+
+std::size_t MemorySentinel::getLifetimeHistograms(LifetimeHistogram* result, std::size_t maxCount) noexcept
+{
+    return MemorySentinelLiveAllocations::readLifetimeHistograms(result, maxCount);
+}
+
+void MemorySentinel::writeLifetimeReport(int fileDescriptor, std::size_t numCallSites) noexcept
+{
+    MemorySentinelLiveAllocations::writeLifetimeReport(fileDescriptor, numCallSites);
+}
+
+std::size_t MemorySentinel::getTopTags(Tag* result, std::size_t maxCount) noexcept
+{
+    return MemorySentinelStatistics::readTopTags(result, maxCount);
+}
+
+MemorySentinel::Scope* MemorySentinel::pushScope(int allocationQuota, TransgressionBehaviour behaviour, const char* tag,
+                                                 RedirectArena arena) noexcept
+{
+    if (m_scopeDepth >= MAX_SCOPE_DEPTH) {
+        return nullptr;
+    }
+    int arenaSlot = -1;
+#if SLB_MEMORY_SENTINEL_ENABLED
+    if (arena.memory != nullptr && arena.size > 0) {
+        const auto begin = reinterpret_cast<std::uintptr_t>(arena.memory);
+        arenaSlot = registerRedirectArena(begin, begin + arena.size);
+        if (arenaSlot < 0) {
+            return nullptr;
+        }
+    }
+#endif
+    const Scope* parent = getCurrentScope();
+    Scope& scope = m_scopes[m_scopeDepth++];
+    scope = Scope();
+    scope.remainingQuota = allocationQuota;
+    scope.transgressionBehaviour = behaviour;
+    if (arenaSlot >= 0) {
+        scope.arenaBegin = static_cast<char*>(arena.memory);
+        scope.arenaEnd = scope.arenaBegin + arena.size;
+        scope.arenaCursor = scope.arenaBegin;
+        scope.arenaSlot = arenaSlot;
+    }
+    if (tag != nullptr) {
+        scope.tag = tag;
+        // the tag is interned once here, so the hooks only need its table slot
+        scope.tagIndex = MemorySentinelActivePolicy::statistics ? MemorySentinelStatistics::internTag(tag) : -1;
+    } else if (parent != nullptr) {
+        scope.tag = parent->tag;
+        scope.tagIndex = parent->tagIndex;
+    }
+    return &scope;
+}
+
+MemorySentinel::Scope MemorySentinel::popScope() noexcept
+{
+    assert(m_scopeDepth > 0);
+    if (m_scopeDepth == 0) {
+        return Scope();
+    }
+    const Scope scope = m_scopes[--m_scopeDepth];
+#if SLB_MEMORY_SENTINEL_ENABLED
+    if (scope.arenaSlot >= 0) {
+        unregisterRedirectArena(scope.arenaSlot);
+    }
+#endif
+    if (m_scopeDepth > 0) {
+        Scope& parent = m_scopes[m_scopeDepth-1];
+        parent.allocations += scope.allocations;
+        parent.allocatedBytes += scope.allocatedBytes;
+        parent.transgressions += scope.transgressions;
+        parent.exemptAllocations += scope.exemptAllocations;
+        parent.redirectedAllocations += scope.redirectedAllocations;
+    }
+    return scope;
+}
+
+MemorySentinel::Context MemorySentinel::captureContext() noexcept
+{
+    Context context;
+    if (const Scope* scope = getInstance().getCurrentScope()) {
+        context.captured = true;
+        context.scope.remainingQuota = scope->remainingQuota;
+        context.scope.transgressionBehaviour = scope->transgressionBehaviour;
+        context.scope.tag = scope->tag;
+        context.scope.tagIndex = scope->tagIndex;
+    }
+    return context;
+}
+
+MemorySentinel::Scope* MemorySentinel::pushContext(const Context& context) noexcept
+{
+    if (m_scopeDepth >= MAX_SCOPE_DEPTH) {
+        return nullptr;
+    }
+    Scope& scope = m_scopes[m_scopeDepth++];
+    scope = context.scope;
+    scope.arenaBegin = scope.arenaEnd = scope.arenaCursor = nullptr;
+    scope.arenaSlot = -1;
+    return &scope;
+}
+
+void MemorySentinel::popContext(Context& context) noexcept
+{
+    assert(m_scopeDepth > 0);
+    if (m_scopeDepth > 0) {
+        context.scope = m_scopes[--m_scopeDepth]; // not rolled up into this thread's enclosing scope
+    }
+}
+
+// MARK: Allowlist
+
+bool MemorySentinel::allowCallerRange(const void* begin, const void* end) noexcept
+{
+    AllowedRange range;
+    range.begin = reinterpret_cast<std::uintptr_t>(begin);
+    range.end = reinterpret_cast<std::uintptr_t>(end);
+    return range.begin < range.end && addAllowedRanges(&range, 1);
+}
+
+#if defined(__linux__) || defined(__FreeBSD__)
+struct SharedObjectQuery
+{
+    const char* name = nullptr;
+    AllowedRange ranges[MemorySentinel::MAX_ALLOWED_RANGES];
+    std::size_t count = 0;
+};
+
+/** dl_iterate_phdr callback: collects the executable segments of the first matching object */
+static int collectExecutableSegments(struct dl_phdr_info* info, std::size_t, void* data) noexcept
+{
+    SharedObjectQuery& query = *static_cast<SharedObjectQuery*>(data);
+    const bool isMainExecutable = info->dlpi_name == nullptr || info->dlpi_name[0] == '\0';
+    const bool matches = query.name == nullptr ? isMainExecutable
+                                               : (!isMainExecutable && strstr(info->dlpi_name, query.name) != nullptr);
+    if (!matches) {
+        return 0; // continue
+    }
+    for (std::size_t i = 0; i < info->dlpi_phnum && query.count < MemorySentinel::MAX_ALLOWED_RANGES; ++i) {
+        const auto& header = info->dlpi_phdr[i];
+        if (header.p_type == PT_LOAD && (header.p_flags & PF_X) != 0) {
+            query.ranges[query.count].begin = info->dlpi_addr + header.p_vaddr;
+            query.ranges[query.count].end = info->dlpi_addr + header.p_vaddr + header.p_memsz;
+            ++query.count;
+        }
+    }
+    return 1; // stop
+}
+#endif
+
+bool MemorySentinel::allowSharedObject(const char* name) noexcept
+{
+#if defined(__linux__) || defined(__FreeBSD__)
+    SharedObjectQuery query;
+    query.name = name;
+    dl_iterate_phdr(collectExecutableSegments, &query);
+    return addAllowedRanges(query.ranges, query.count);
+#else
+    (void) name;
+    return false;
+#endif
+}
+
+bool MemorySentinel::allowSymbol(const char* name) noexcept
+{
+#if defined(__GLIBC__)
+    // resolved once: the symbol's extent is cached as an address range
+    void* address = dlsym(RTLD_DEFAULT, name);
+    Dl_info info;
+    void* symbolEntry = nullptr;
+    if (address == nullptr || dladdr1(address, &info, &symbolEntry, RTLD_DL_SYMENT) == 0 || symbolEntry == nullptr) {
+        return false;
+    }
+    const auto* symbol = static_cast<const ElfW(Sym)*>(symbolEntry);
+    if (symbol->st_size == 0) {
+        return false;
+    }
+    AllowedRange range;
+    range.begin = reinterpret_cast<std::uintptr_t>(address);
+    range.end = range.begin + symbol->st_size;
+    return addAllowedRanges(&range, 1);
+#else
+    (void) name;
+    return false;
+#endif
+}
+
+void MemorySentinel::clearAllowList() noexcept
+{
+    updateAllowList([](AllowList& list) {
+        list.count = 0;
+        return true;
+    });
+}
+
+std::size_t MemorySentinel::getAllowListSize() noexcept
+{
+    std::lock_guard<std::mutex> lock(configWriteMutex);
+    return publishedAllowList.current().count;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Fork safety
+// Before fork, the forking thread takes every lock of the sentinel (always in this order), so no other thread holds one
+// in the middle of an update that the child would inherit half-done. Only the forking thread exists in the child: the
+// locks are released there, the background threads are reset to stopped and the sentinel starts disarmed with fresh
+// statistics and an empty live allocation table.
+#if defined(__unix__) || defined(__APPLE__)
+static void prepareFork() noexcept
+{
+    MemorySentinelControl::prepareFork();
+    MemorySentinelSampler::prepareFork();
+    MemorySentinelLiveAllocations::prepareFork();
+    MemorySentinelPool::prepareFork();
+    configWriteMutex.lock();
+}
+
+static void parentAfterFork() noexcept
+{
+    configWriteMutex.unlock();
+    MemorySentinelPool::afterFork();
+    MemorySentinelLiveAllocations::parentAfterFork();
+    MemorySentinelSampler::parentAfterFork();
+    MemorySentinelControl::parentAfterFork();
+}
+
+static void childAfterFork() noexcept
+{
+    configWriteMutex.unlock();
+    MemorySentinelPool::afterFork();
+    MemorySentinelLiveAllocations::childAfterFork();
+    MemorySentinelSampler::childAfterFork();
+    MemorySentinelControl::childAfterFork();
+
+    // a scope entered before fork stays on this thread's stack, but it is no longer armed
+    MemorySentinel& instance = MemorySentinel::getInstance();
+    instance.setArmed(false);
+    instance.clearTransgressions();
+    // the references of the other threads vanished with them, the override stays
+    numArmedThreads.store(isDisarmOverrideSet.load() ? -DISARM_OVERRIDE_BIAS : 0);
+    updateConfig([](MemorySentinel::Config& config) { ++config.quotaGeneration; });
+    MemorySentinel::resetStatistics();
+    threadCounters = MemorySentinel::ThreadCounters();
+    samplingCountdown = 0;
+}
+#endif
+
+bool MemorySentinel::installForkHandlers() noexcept
+{
+#if defined(__unix__) || defined(__APPLE__)
+    static const bool isInstalled = (pthread_atfork(prepareFork, parentAfterFork, childAfterFork) == 0);
+    return isInstalled;
+#else
+    return false;
+#endif
+}
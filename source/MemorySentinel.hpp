@@ -10,6 +10,8 @@
 
 #include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 
 // Macro to detect if exceptions are disabled (works on GCC, Clang and MSVC)
 #ifndef __has_feature
@@ -19,6 +21,43 @@
   #define SLB_EXCEPTIONS_DISABLED 1
 #endif
 
+// Return address of the current function = call site of the allocation (allowlist, statistics, live allocations)
+#if defined(__clang__) || defined(__GNUC__)
+    #define SLB_RETURN_ADDRESS() __builtin_return_address(0)
+#elif defined(_MSC_VER)
+    #include <intrin.h>
+    #define SLB_RETURN_ADDRESS() _ReturnAddress()
+#else
+    #define SLB_RETURN_ADDRESS() nullptr
+#endif
+
+// Compile-time feature selection (CMake options MEMORY_SENTINEL_ENABLED, _STATISTICS, _CALL_SITES). All on by default.
+#ifndef SLB_MEMORY_SENTINEL_ENABLED
+  #define SLB_MEMORY_SENTINEL_ENABLED 1     // replace new/delete (and malloc/free) at all
+#endif
+#ifndef SLB_MEMORY_SENTINEL_STATISTICS
+  #define SLB_MEMORY_SENTINEL_STATISTICS 1  // record allocation statistics in the hooks
+#endif
+#ifndef SLB_MEMORY_SENTINEL_CALL_SITES
+  #define SLB_MEMORY_SENTINEL_CALL_SITES 1  // capture the call site of each recorded allocation
+#endif
+
+/**
+ * Selects at compile time which features of the hooks are instantiated. Disabled features are removed by the
+ * compiler instead of being skipped by a runtime branch. Each feature requires the previous ones.
+ */
+template<bool Enabled, bool Statistics, bool CallSites>
+struct MemorySentinelPolicy
+{
+    static constexpr bool enabled = Enabled;
+    static constexpr bool statistics = Enabled && Statistics;
+    static constexpr bool callSites = Enabled && Statistics && CallSites;
+};
+
+using MemorySentinelActivePolicy = MemorySentinelPolicy<SLB_MEMORY_SENTINEL_ENABLED != 0,
+                                                        SLB_MEMORY_SENTINEL_STATISTICS != 0,
+                                                        SLB_MEMORY_SENTINEL_CALL_SITES != 0>;
+
 /**
  * Singleton that hijacks all calls on new, new[], delete and delete[] as well as malloc/free.
  * This is useful to detect whether memory has been allocated in unit tests.
@@ -30,19 +69,185 @@ public:
         LOG,
         THROW_EXCEPTION,
         SILENT,
+        REDIRECT, ///< serve allocations from the scope's RedirectArena (throws std::bad_alloc when it is exhausted)
+    };
+
+    /**
+     * Immutable configuration block read by the hooks. It is only ever replaced as a whole, so the hooks read it
+     * through a single atomic pointer, always see a consistent policy and reconfiguration never adds locking to the
+     * allocation path.
+     */
+    struct Config
+    {
+        bool hijackActive = false;      ///< true while any thread is armed and not overridden (not published, see setArmed / setDisarmOverride)
+        bool statisticsEnabled = false; ///< record allocation statistics (armed or not)
+        TransgressionBehaviour transgressionBehaviour = TransgressionBehaviour::LOG;
+        int samplingInterval = 1;       ///< only every n-th allocation/deallocation is recorded in the statistics
+        int allocationQuota = 0;        ///< allocation quota in bytes (consumption is tracked per quotaGeneration)
+        std::uint32_t quotaGeneration = 0;
+        bool liveAllocationsTracked = false; ///< record live allocations in the private arena (leak report)
+        bool fallbackPoolUsed = false;  ///< serve quota-permitted allocations from the preallocated pool
+    };
+
+    /** Process-wide allocation counters (only sampled events are counted, see Config::samplingInterval) */
+    struct Statistics
+    {
+        std::uint64_t allocations = 0;
+        std::uint64_t deallocations = 0;
+        std::uint64_t allocatedBytes = 0;
+        std::uint64_t permittedAllocations = 0;
+        std::uint64_t exemptAllocations = 0;  ///< allocations while armed, but within a ScopedAllowAllocation
+        std::uint64_t transgressions = 0;
+        std::uint64_t liveBlocks = 0;      ///< allocations - deallocations
+        std::uint64_t liveBytes = 0;       ///< usable bytes allocated - usable bytes freed (if supported by platform)
+    };
+
+    /**
+     * Allocations and deallocations made by the calling thread, counted in the hooks whenever statistics are compiled
+     * in (regardless of setStatisticsEnabled and sampling, and not reset by resetStatistics). Meant for deltas, e.g.
+     * the allocations of a test case. The sentinel's own allocations and redirected allocations are not counted.
+     */
+    struct ThreadCounters
+    {
+        std::uint64_t allocations = 0;
+        std::uint64_t deallocations = 0;
+        std::uint64_t allocatedBytes = 0; ///< requested bytes
+    };
+
+    /** Usage of the fallback pool (see setFallbackPoolEnabled) */
+    struct FallbackPoolStatistics
+    {
+        std::uint64_t allocations = 0; ///< permitted allocations served by the pool
+        std::uint64_t exhaustions = 0; ///< permitted allocations served by malloc (too large or size class exhausted)
+        std::uint64_t blocksInUse = 0;
+    };
+    static constexpr std::size_t DEFAULT_FALLBACK_POOL_BYTES = 64 * 1024; ///< per size class
+
+    /** Allocation totals of a single call site (the return address of the allocation function) */
+    struct CallSite
+    {
+        const void* address = nullptr;
+        std::uint64_t allocations = 0;
+        std::uint64_t allocatedBytes = 0;
+    };
+
+    /**
+     * Growing reallocs of a call site. A small-step growth enlarges a block by less than half its size; chains of them
+     * (e.g. a buffer growing linearly) copy the data over and over and are candidates for reserving up front.
+     */
+    struct ReallocSite
+    {
+        const void* address = nullptr;
+        std::uint64_t growingReallocations = 0;
+        std::uint64_t smallStepGrowths = 0;
+        std::uint64_t copiedBytes = 0; ///< sum of the old sizes (upper bound, realloc may grow in place)
+        std::uint64_t longestChain = 0; ///< longest run of consecutive reallocs of the same block
+    };
+
+    /**
+     * Number of allocations whose requested size falls into a size class (sizes above the previous class, up to maxSize).
+     * The last class is open-ended: its maxSize is UINT64_MAX.
+     */
+    struct SizeClass
+    {
+        std::uint64_t maxSize = 0;
+        std::uint64_t allocations = 0;
+    };
+    static constexpr std::size_t NUM_SIZE_CLASSES = 252; ///< 1..8, then a power of two with 4 sub-buckets each
+
+    static constexpr std::size_t NUM_LIFETIME_BUCKETS = 40;
+
+    /** Lifetimes of the tracked blocks freed at one call site: bucket i counts lifetimes in [2^i, 2^(i+1)) ns */
+    struct LifetimeHistogram
+    {
+        const void* address = nullptr;  ///< call site of the allocation
+        std::uint64_t frees = 0;
+        std::uint64_t totalLifetimeNs = 0;
+        std::uint64_t buckets[NUM_LIFETIME_BUCKETS] = {};
+    };
+
+    /** Allocation totals of all scopes with the same tag, across all threads */
+    struct Tag
+    {
+        const char* name = nullptr;
+        std::uint64_t allocations = 0;
+        std::uint64_t allocatedBytes = 0;
+        std::uint64_t transgressions = 0;
+    };
+
+    /** State of one ScopedMemorySentinel on the per-thread scope stack */
+    struct Scope
+    {
+        int remainingQuota = 0;            ///< allocation quota in bytes
+        TransgressionBehaviour transgressionBehaviour = TransgressionBehaviour::LOG;
+        std::uint64_t allocations = 0;     ///< allocations within the scope (incl. its nested scopes)
+        std::uint64_t allocatedBytes = 0;
+        std::uint64_t transgressions = 0;
+        std::uint64_t exemptAllocations = 0;
+        const char* tag = nullptr;         ///< inherited from the enclosing scope if not set
+        int tagIndex = -1;                 ///< slot of the tag in the statistics' tag table (-1: not recorded)
+        std::uint64_t redirectedAllocations = 0; ///< transgressions served by the arena (REDIRECT)
+        char* arenaBegin = nullptr;        ///< the scope's RedirectArena (nullptr: none)
+        char* arenaEnd = nullptr;
+        char* arenaCursor = nullptr;       ///< bump pointer, i.e. the arena is reset when the scope exits
+        int arenaSlot = -1;                ///< slot in the process-wide registry of arenas
+    };
+    static constexpr int MAX_SCOPE_DEPTH = 16;
+
+    /**
+     * Caller-provided memory for TransgressionBehaviour::REDIRECT. While registered with a scope, deleting a block of
+     * the arena (from any thread) is a no-op; blocks must not outlive the scope.
+     */
+    struct RedirectArena
+    {
+        void* memory;
+        std::size_t size;
+    };
+    static constexpr std::size_t MAX_REDIRECT_ARENAS = 64; ///< registered at the same time, across all threads
+
+    /**
+     * Attribution of a task that hops between threads (e.g. its continuations on a thread pool), see captureContext()
+     * and ScopedContextRestore: the tag, remaining quota and behaviour of the scope it was captured in, and the
+     * counters of the task itself (zero when captured).
+     */
+    struct Context
+    {
+        bool captured = false; ///< false if captured outside of any scope: restoring it does nothing
+        Scope scope;           ///< without redirect arena (it stays with the scope that registered it)
     };
 
     /** Returns a MemorySentinel for the current thread. */
     static MemorySentinel& getInstance() noexcept;
     
+    /**
+     * Returns a copy of the currently published configuration.
+     * Writer cost: the setters (except setArmed) serialize on a mutex and never wait for readers. They write into the
+     * next block of a small ring; a hook that was reading a block while it is reused notices the sequence change and
+     * retries. Don't reconfigure from a real-time thread. The hooks only pay a pointer load and a sequence check.
+     */
+    static Config getConfig() noexcept;
+
+    /**
+     * Arms (or disarms) the calling thread. The sentinel is active process-wide while any thread is armed, so a thread
+     * can't disarm another. Arming and disarming is a single atomic operation (wait-free), safe in real-time threads.
+     */
     void setArmed(bool value) noexcept;
     bool isArmed() const noexcept { return m_allocationForbidden.load(); }
 
-    static void setTransgressionBehaviour(TransgressionBehaviour b) noexcept { m_transgressionBehaviour.store(b); }
-    static TransgressionBehaviour getTransgressionBehaviour() noexcept { return m_transgressionBehaviour.load(); }
+    /**
+     * Process-wide kill switch (e.g. the control channel's `disarm`): while set, the sentinel is inactive no matter how
+     * many threads are armed. The threads keep their references, so clearing it restores the previous state.
+     */
+    static void setDisarmOverride(bool value) noexcept;
+    static bool isDisarmOverridden() noexcept;
+
+    /** NOTE: within a ScopedMemorySentinel, this applies to the innermost scope of the calling thread only */
+    static void setTransgressionBehaviour(TransgressionBehaviour b) noexcept;
+    static TransgressionBehaviour getTransgressionBehaviour() noexcept;
 
-    static void setAllocationQuota(int numBytes) noexcept { m_allocationQuota.store(numBytes); }
-    static int getRemainingAllocationQuota() noexcept { return m_allocationQuota.load(); }
+    /** NOTE: within a ScopedMemorySentinel, this applies to the innermost scope of the calling thread only */
+    static void setAllocationQuota(int numBytes) noexcept;
+    static int getRemainingAllocationQuota() noexcept;
 
     void registerTransgression() noexcept { m_transgressionOccured.store(true); }
     void clearTransgressions() noexcept { m_transgressionOccured.exchange(false); }
@@ -51,46 +256,321 @@ public:
     /** NOTE: this clear the transgression upon call */
     bool getAndClearTransgressionsOccured() noexcept;
 
+    static void setStatisticsEnabled(bool value) noexcept;
+    static bool isStatisticsEnabled() noexcept { return getConfig().statisticsEnabled; }
+
+    /** Record only every n-th allocation/deallocation in the statistics (1 = record everything) */
+    static void setSamplingInterval(int interval) noexcept;
+    static int getSamplingInterval() noexcept { return getConfig().samplingInterval; }
+
+    static Statistics getStatistics() noexcept;
+    static void resetStatistics() noexcept;
+
+    /** Counters of the calling thread (all zero if statistics are compiled out) */
+    static ThreadCounters getThreadCounters() noexcept;
+
+    /**
+     * Fills result with up to maxCount call sites, sorted by allocated bytes (descending).
+     * @return the number of call sites written
+     */
+    static std::size_t getTopCallSites(CallSite* result, std::size_t maxCount) noexcept;
+
+    /** Allocation function of an allocator that bypasses the global hooks (see allocateMonitored) */
+    using UpstreamAllocate = void* (*)(void* upstream, std::size_t size, std::size_t alignment);
+    using UpstreamDeallocate = void (*)(void* upstream, void* ptr, std::size_t size, std::size_t alignment);
+
+    /**
+     * Allocates with an allocator that bypasses the global hooks (e.g. a std::pmr::memory_resource, see
+     * SentinelMemoryResource). If armed, the allocation is subject to the same checks as in the hooks (allowlist,
+     * scope, quota, transgression behaviour; REDIRECT serves it from the scope's arena), and it is recorded in the
+     * statistics. Allocations made by upstream itself are not monitored again.
+     * @param callSite return address attributed to the allocation (allowlist, statistics)
+     * @param tagIndex tag the allocation is attributed to while statistics are enabled, see internTag() (-1: none)
+     * @throws std::bad_alloc with TransgressionBehaviour::THROW_EXCEPTION, or whatever upstream throws
+     */
+    static void* allocateMonitored(std::size_t size, std::size_t alignment, const void* callSite,
+                                   UpstreamAllocate allocate, void* upstream, int tagIndex = -1);
+    /**
+     * Interns the tag "label [qualifier]" (or just one of them, if the other is nullptr) in the statistics' tag table,
+     * e.g. for SentinelAllocator. Composed names are copied, so the parts don't need static storage duration.
+     * @return the tag's slot for allocateMonitored() (-1 if the tag table is full or statistics are compiled out)
+     */
+    static int internTag(const char* label, const char* qualifier = nullptr) noexcept;
+
+    /** Deallocates a block of allocateMonitored() (blocks of a redirect arena are ignored) */
+    static void deallocateMonitored(void* ptr, std::size_t size, std::size_t alignment, const void* callSite,
+                                    UpstreamDeallocate deallocate, void* upstream);
+
+    /**
+     * Fills result with up to maxCount realloc call sites, sorted by small-step growths, then copied bytes (descending).
+     * Reallocs are recorded with the statistics where malloc/realloc are hooked (not with glibc).
+     * @return the number of call sites written
+     */
+    static std::size_t getTopReallocSites(ReallocSite* result, std::size_t maxCount) noexcept;
+
+    /**
+     * Histogram of the requested sizes (recorded with the statistics): fills result with the non-empty size classes,
+     * ascending. Pass NUM_SIZE_CLASSES entries to get all of them.
+     * @return the number of size classes written
+     */
+    static std::size_t getSizeHistogram(SizeClass* result, std::size_t maxCount) noexcept;
+
+    /**
+     * Suggests slab size classes for a pool allocator: the most frequent size classes that together cover the given
+     * share of all allocations, ascending by size.
+     * @return the number of size classes written
+     */
+    static std::size_t suggestSizeClasses(SizeClass* result, std::size_t maxCount, double coverage = 0.95) noexcept;
+
+    /**
+     * Fills result with up to maxCount scope tags, sorted by transgressions, then allocated bytes (descending).
+     * @return the number of tags written
+     */
+    static std::size_t getTopTags(Tag* result, std::size_t maxCount) noexcept;
+
+    /**
+     * Opt-in: track every live allocation (address, size, allocating stack, scope tag) in a table in the sentinel's
+     * private arena, as required by the leak report. Returns false if not supported on this platform.
+     */
+    static bool setLiveAllocationTrackingEnabled(bool value) noexcept;
+    static bool isLiveAllocationTrackingEnabled() noexcept { return getConfig().liveAllocationsTracked; }
+
+    /**
+     * Opt-in: while armed, serve allocations permitted by the quota with new from a preallocated, lock-free pool of
+     * power-of-two size classes (16 to 4096 bytes), instead of malloc. This makes budgeted allocations on a real-time
+     * thread deterministic in time. The pool is mapped and pre-faulted on first enable (bytesPerSizeClass per size
+     * class) and kept: its blocks are recognized by address when deleted, also after disabling.
+     * Returns false if not supported on this platform.
+     */
+    static bool setFallbackPoolEnabled(bool value, std::size_t bytesPerSizeClass = DEFAULT_FALLBACK_POOL_BYTES) noexcept;
+    static bool isFallbackPoolEnabled() noexcept { return getConfig().fallbackPoolUsed; }
+    static FallbackPoolStatistics getFallbackPoolStatistics() noexcept;
+
+    /**
+     * Writes the tracked blocks that are still alive to a file descriptor, grouped by allocating stack and sorted by
+     * total bytes. Generated from the private arena only, i.e. without using the process heap.
+     * @param scopeTag only report blocks allocated while a scope with this tag was armed (nullptr: all blocks)
+     * @return the number of reported blocks
+     */
+    static std::size_t writeLeakReport(int fileDescriptor, const char* scopeTag = nullptr) noexcept;
+
+    /** Enables live allocation tracking and writes the leak report to path (nullptr: stderr) when the process exits */
+    static bool setLeakReportAtExit(const char* path = nullptr, const char* scopeTag = nullptr) noexcept;
+
+    /**
+     * Object lifetimes per call site (requires live allocation tracking): fills result with up to maxCount
+     * histograms, sorted by the number of frees (descending). Reset with resetStatistics().
+     * @return the number of histograms written
+     */
+    static std::size_t getLifetimeHistograms(LifetimeHistogram* result, std::size_t maxCount) noexcept;
+    /** Writes the lifetime histograms of the numCallSites call sites with the most frees to a file descriptor */
+    static void writeLifetimeReport(int fileDescriptor, std::size_t numCallSites = 10) noexcept;
+
+    static constexpr std::size_t MAX_ALLOWED_RANGES = 64;
+
+    /**
+     * Allowlist: allocations and deallocations called from allowed code (matched by the return address of the
+     * allocation function) are not reported while armed, nor charged to the quota. They are counted as exempt instead.
+     * The ranges are resolved once when added, so the hooks only perform a binary search.
+     * @return false if nothing was found or the allowlist is full
+     */
+    static bool allowCallerRange(const void* begin, const void* end) noexcept;
+    /** Allows the code of the first loaded object whose path contains name (nullptr: main executable). Linux/BSD only. */
+    static bool allowSharedObject(const char* name) noexcept;
+    /** Allows the code of an exported function, looked up by name. glibc only. */
+    static bool allowSymbol(const char* name) noexcept;
+    static void clearAllowList() noexcept;
+    /** Number of (merged) address ranges on the allowlist */
+    static std::size_t getAllowListSize() noexcept;
+
+    /**
+     * Registers pthread_atfork handlers (once, further calls have no effect), so a child process does not inherit a
+     * lock held by another thread, nor the sentinel's state: the child starts disarmed, with reset statistics and
+     * counters, an empty live allocation table (without leak report at exit), and with the control channel, signal
+     * dump and sampler stopped (restart them in the child if needed).
+     * Call before the process forks while other threads use the sentinel. POSIX only.
+     * @return false if the handlers could not be registered
+     */
+    static bool installForkHandlers() noexcept;
+
+    /**
+     * Pushes a scope onto this thread's scope stack (allocation-free). Returns nullptr if the stack is full (or the
+     * registry of redirect arenas, see MAX_REDIRECT_ARENAS).
+     * @param tag string with static storage duration (e.g. a literal) that names the scope in the per-tag statistics
+     * @param arena memory that serves the scope's transgressions with TransgressionBehaviour::REDIRECT
+     */
+    Scope* pushScope(int allocationQuota, TransgressionBehaviour behaviour, const char* tag = nullptr,
+                     RedirectArena arena = RedirectArena()) noexcept;
+    /** Pops the innermost scope, adds its counters to the enclosing scope and returns its final state */
+    Scope popScope() noexcept;
+    Scope* getCurrentScope() noexcept { return m_scopeDepth > 0 ? &m_scopes[m_scopeDepth-1] : nullptr; }
+
+    /** Captures the innermost scope of the calling thread, to be restored on another thread (allocation-free) */
+    static Context captureContext() noexcept;
+    /**
+     * Pushes the scope of a captured context onto this thread's scope stack. Unlike a nested scope, it does not inherit
+     * from the enclosing scope of this thread, nor roll up into it. Returns nullptr if the stack is full.
+     */
+    Scope* pushContext(const Context& context) noexcept;
+    /** Pops the scope of a context pushed with pushContext() and stores its quota and counters back into context */
+    void popContext(Context& context) noexcept;
+    int getScopeDepth() const noexcept { return m_scopeDepth; }
+
+    /** While allowed (see ScopedAllowAllocation), this thread's allocations are not reported, but counted as exempt */
+    void pushAllowAllocation() noexcept { ++m_allowAllocationDepth; }
+    void popAllowAllocation() noexcept { assert(m_allowAllocationDepth > 0); --m_allowAllocationDepth; }
+    bool isAllocationAllowed() const noexcept { return m_allowAllocationDepth > 0; }
+
 private:
     MemorySentinel() = default; // Singleton = private ctor
     
-    static std::atomic<TransgressionBehaviour> m_transgressionBehaviour;
-    static std::atomic<int> m_allocationQuota; // allocation Quota in bytes
-    
     std::atomic<bool> m_allocationForbidden { false };
     std::atomic<bool> m_transgressionOccured { false };
+    
+    Scope m_scopes[MAX_SCOPE_DEPTH];
+    int m_scopeDepth = 0;
+    int m_allowAllocationDepth = 0;
 };
 
 
+/**
+ * Arms the sentinel for the current scope. Scopes can be nested: each scope has its own quota, behaviour and counters
+ * (kept on a per-thread stack), the results of an inner scope roll up into the outer scope on exit, and the sentinel
+ * is only disarmed when the outermost scope exits.
+ * Upon exit, a scope with TransgressionBehaviour::LOG asserts if a transgression occurred.
+ *
+ * A tagged scope, e.g. ScopedMemorySentinel("mixer.process"), additionally attributes all allocations within it
+ * (and within nested untagged scopes) to its tag, aggregated across threads (see MemorySentinel::getTopTags).
+ *
+ * A redirecting scope, e.g. ScopedMemorySentinel(MemorySentinel::RedirectArena{buffer, sizeof(buffer)}), serves the
+ * allocations within it by bumping a pointer in the given buffer (reset when the scope exits), and delete ignores them.
+ */
 class ScopedMemorySentinel
 {
 public:
     explicit ScopedMemorySentinel(int allocationQuotaBytes = 0)
+        : ScopedMemorySentinel(nullptr, allocationQuotaBytes)
+    {}
+
+    ScopedMemorySentinel(int allocationQuotaBytes, MemorySentinel::TransgressionBehaviour behaviour)
+        : ScopedMemorySentinel(nullptr, allocationQuotaBytes, behaviour)
+    {}
+
+    explicit ScopedMemorySentinel(const char* tag, int allocationQuotaBytes = 0)
+        : ScopedMemorySentinel(tag, allocationQuotaBytes, allocationQuotaBytes > 0 ? MemorySentinel::TransgressionBehaviour::THROW_EXCEPTION
+                                                                                   : MemorySentinel::TransgressionBehaviour::LOG)
+    {}
+
+    explicit ScopedMemorySentinel(MemorySentinel::RedirectArena arena, const char* tag = nullptr, int allocationQuotaBytes = 0)
+        : ScopedMemorySentinel(tag, allocationQuotaBytes, MemorySentinel::TransgressionBehaviour::REDIRECT, arena)
+    {}
+
+    ScopedMemorySentinel(const char* tag, int allocationQuotaBytes, MemorySentinel::TransgressionBehaviour behaviour,
+                         MemorySentinel::RedirectArena arena = MemorySentinel::RedirectArena())
     {
-        MemorySentinel::setAllocationQuota(allocationQuotaBytes);
-        if (allocationQuotaBytes > 0) {
-            MemorySentinel::setTransgressionBehaviour(MemorySentinel::TransgressionBehaviour::THROW_EXCEPTION);
-        } else {
-            MemorySentinel::setTransgressionBehaviour(MemorySentinel::TransgressionBehaviour::LOG);
-        }
         auto& sentinel = MemorySentinel::getInstance();
-        sentinel.clearTransgressions();
-        sentinel.setArmed(true);
+        if (sentinel.getScopeDepth() == 0) {
+            sentinel.clearTransgressions();
+        }
+        m_scope = sentinel.pushScope(allocationQuotaBytes, behaviour, tag, arena);
+        assert(m_scope != nullptr && "MemorySentinel: too many nested scopes (or redirect arenas)!");
+        if (!sentinel.isArmed()) {
+            sentinel.setArmed(true);
+        }
     }
 
     ~ScopedMemorySentinel()
     {
+        if (m_scope == nullptr) {
+            return;
+        }
         auto& sentinel = MemorySentinel::getInstance();
-        sentinel.setArmed(false);
-        if (sentinel.getAndClearTransgressionsOccured() &&
-            MemorySentinel::getTransgressionBehaviour() != MemorySentinel::TransgressionBehaviour::THROW_EXCEPTION) {
-            
+        const MemorySentinel::Scope result = sentinel.popScope();
+        if (sentinel.getScopeDepth() == 0) {
+            sentinel.setArmed(false);
+            sentinel.clearTransgressions();
+        }
+        if (result.transgressions > 0 && result.transgressionBehaviour == MemorySentinel::TransgressionBehaviour::LOG) {
             assert(false && "MemorySentinel was triggered!");
         }
     }
 
+    /** The state of this scope (counters include nested scopes that have already exited) */
+    const MemorySentinel::Scope& getScope() const noexcept { assert(m_scope); return *m_scope; }
+
     ScopedMemorySentinel(const ScopedMemorySentinel&) = delete;                   ///< Copy ctor
     ScopedMemorySentinel& operator= (const ScopedMemorySentinel&) = delete;       ///< Copy assignment operator
     ScopedMemorySentinel(ScopedMemorySentinel&&) noexcept = delete;               ///< Move ctor
     ScopedMemorySentinel& operator= (ScopedMemorySentinel&&) noexcept = delete;   ///< Move assignment operator
+
+private:
+    MemorySentinel::Scope* m_scope = nullptr;
+};
+
+/**
+ * Temporarily exempts the current thread from an armed sentinel, e.g. for a known, budgeted slow path like a one-time
+ * lazy initialization. Neither the armed state nor the quota are touched; the exempt allocations are counted in
+ * Statistics::exemptAllocations and Scope::exemptAllocations instead of being reported as transgressions.
+ */
+class ScopedAllowAllocation
+{
+public:
+    ScopedAllowAllocation() noexcept { MemorySentinel::getInstance().pushAllowAllocation(); }
+    ~ScopedAllowAllocation() { MemorySentinel::getInstance().popAllowAllocation(); }
+
+    ScopedAllowAllocation(const ScopedAllowAllocation&) = delete;                   ///< Copy ctor
+    ScopedAllowAllocation& operator= (const ScopedAllowAllocation&) = delete;       ///< Copy assignment operator
+    ScopedAllowAllocation(ScopedAllowAllocation&&) noexcept = delete;               ///< Move ctor
+    ScopedAllowAllocation& operator= (ScopedAllowAllocation&&) noexcept = delete;   ///< Move assignment operator
+};
+
+/**
+ * Restores a context captured with MemorySentinel::captureContext() on the thread that runs a task (or one of its
+ * continuations), so its allocations are attributed to the tag and charged to the quota of the scope that started it.
+ * Upon exit, the remaining quota and the counters are stored back into the context, which travels on with the task.
+ * Restoring costs a copy of the scope into thread-local storage and, unless this thread is already armed, arming it
+ * (an atomic increment): the sentinel stays active while the context is restored, even if its origin scope exits.
+ *
+ *   auto context = MemorySentinel::captureContext();        // within a ScopedMemorySentinel
+ *   pool.post([&context] { ScopedContextRestore restore(context); process(); });
+ */
+class ScopedContextRestore
+{
+public:
+    explicit ScopedContextRestore(MemorySentinel::Context& context) noexcept
+        : m_context(context)
+    {
+        if (!context.captured) {
+            return;
+        }
+        auto& sentinel = MemorySentinel::getInstance();
+        m_scope = sentinel.pushContext(context);
+        assert(m_scope != nullptr && "MemorySentinel: too many nested scopes!");
+        if (m_scope != nullptr && !sentinel.isArmed()) {
+            sentinel.setArmed(true);
+            m_hasArmed = true;
+        }
+    }
+
+    ~ScopedContextRestore()
+    {
+        if (m_scope == nullptr) {
+            return;
+        }
+        auto& sentinel = MemorySentinel::getInstance();
+        sentinel.popContext(m_context);
+        if (m_hasArmed) {
+            sentinel.setArmed(false);
+        }
+    }
+
+    ScopedContextRestore(const ScopedContextRestore&) = delete;                   ///< Copy ctor
+    ScopedContextRestore& operator= (const ScopedContextRestore&) = delete;       ///< Copy assignment operator
+    ScopedContextRestore(ScopedContextRestore&&) noexcept = delete;               ///< Move ctor
+    ScopedContextRestore& operator= (ScopedContextRestore&&) noexcept = delete;   ///< Move assignment operator
+
+private:
+    MemorySentinel::Context& m_context;
+    MemorySentinel::Scope* m_scope = nullptr;
+    bool m_hasArmed = false;
 };
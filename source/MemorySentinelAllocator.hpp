@@ -0,0 +1,133 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include "MemorySentinel.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+/**
+ * Readable name of a type, derived from the compiler's signature of a function template instantiated for it. The
+ * signature is a string literal, i.e. a compile-time id of the type; it is trimmed to the type name once per type.
+ */
+template<class T>
+class MemorySentinelTypeName
+{
+public:
+    static const char* get() noexcept
+    {
+        static const MemorySentinelTypeName name(signature());
+        return name.m_name;
+    }
+
+private:
+    static const char* signature() noexcept
+    {
+#if defined(_MSC_VER)
+        return __FUNCSIG__;      // "... MemorySentinelTypeName<int>::signature(void) noexcept"
+#elif defined(__clang__) || defined(__GNUC__)
+        return __PRETTY_FUNCTION__; // "... signature() [with T = int]" (GCC), "... signature() [T = int]" (Clang)
+#else
+        return "?";
+#endif
+    }
+
+    explicit MemorySentinelTypeName(const char* signature) noexcept
+    {
+#if defined(_MSC_VER)
+        const char* begin = strstr(signature, "MemorySentinelTypeName<");
+        begin = begin != nullptr ? begin + strlen("MemorySentinelTypeName<") : signature;
+        const char* end = strstr(begin, ">::signature");
+#else
+        const char* begin = strstr(signature, "T = ");
+        begin = begin != nullptr ? begin + strlen("T = ") : signature;
+        const char* end = strrchr(begin, ']');
+#endif
+        std::size_t length = end != nullptr ? static_cast<std::size_t>(end - begin) : strlen(begin);
+        length = length < sizeof(m_name) - 1 ? length : sizeof(m_name) - 1;
+        memcpy(m_name, begin, length);
+        m_name[length] = '\0';
+    }
+
+    char m_name[128];
+};
+
+/**
+ * STL allocator that attributes the allocations of a container to a tag in the statistics, so that the per-tag
+ * report (MemorySentinel::getTopTags) shows which containers cause the most allocator traffic. The tag is the
+ * container's label and value type, e.g. "mixer.voices [Voice]", or only the value type if no label is given.
+ * Allocations go to the global heap, are subject to the armed sentinel like the hooks (see
+ * MemorySentinel::allocateMonitored) and are recorded in the statistics once. Tags are recorded while statistics are
+ * enabled.
+ *
+ *   std::vector<Voice, SentinelAllocator<Voice>> voices(SentinelAllocator<Voice>("mixer.voices"));
+ *
+ * The tag is resolved when an allocator is constructed from a label; rebound copies (e.g. for the nodes of a
+ * std::unordered_map) keep it. All instances allocate from the same heap, so they compare equal.
+ */
+template<class T>
+class SentinelAllocator
+{
+public:
+    using value_type = T;
+
+    SentinelAllocator() noexcept : SentinelAllocator(nullptr) {}
+
+    /** @param label name of the container (copied into the tag, so it does not need static storage duration) */
+    explicit SentinelAllocator(const char* label) noexcept
+        : m_tagIndex(MemorySentinel::internTag(label, MemorySentinelTypeName<T>::get()))
+    {}
+
+    template<class U>
+    SentinelAllocator(const SentinelAllocator<U>& other) noexcept // NOLINT: implicit rebind conversion
+        : m_tagIndex(other.getTagIndex())
+    {}
+
+    /** Throws std::bad_array_new_length if n > max_size() (like std::allocator) */
+    T* allocate(std::size_t n)
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "SentinelAllocator: over-aligned types are not supported");
+        if (n > max_size()) {
+#ifdef SLB_EXCEPTIONS_DISABLED
+            assert(false && "[Exceptions disabled] SentinelAllocator: allocation size overflows");
+            return nullptr;
+#else
+            throw std::bad_array_new_length();
+#endif
+        }
+        return static_cast<T*>(MemorySentinel::allocateMonitored(n * sizeof(T), alignof(T), SLB_RETURN_ADDRESS(),
+                                                                 &allocateUpstream, nullptr, m_tagIndex));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept
+    {
+        MemorySentinel::deallocateMonitored(ptr, n * sizeof(T), alignof(T), SLB_RETURN_ADDRESS(), &deallocateUpstream, nullptr);
+    }
+
+    static constexpr std::size_t max_size() noexcept { return SIZE_MAX / sizeof(T); }
+
+    /** Slot of this allocator's tag in the statistics (-1: none) */
+    int getTagIndex() const noexcept { return m_tagIndex; }
+
+private:
+    static void* allocateUpstream(void*, std::size_t size, std::size_t) { return ::operator new(size); }
+    static void deallocateUpstream(void*, void* ptr, std::size_t, std::size_t) { ::operator delete(ptr); }
+
+    int m_tagIndex = -1;
+};
+
+template<class T, class U>
+bool operator== (const SentinelAllocator<T>&, const SentinelAllocator<U>&) noexcept { return true; }
+
+template<class T, class U>
+bool operator!= (const SentinelAllocator<T>&, const SentinelAllocator<U>&) noexcept { return false; }
@@ -0,0 +1,55 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/mman.h>
+#elif defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#endif
+
+/**
+ * The sentinel's private arena: zero-initialized pages mapped directly from the OS, bypassing the (hooked) process
+ * heap. Pages are only committed when first touched, so large, sparsely used tables are cheap.
+ */
+namespace MemorySentinelArena
+{
+/** Maps numBytes of zeroed memory. Returns nullptr if not supported or out of memory. */
+inline void* map(std::size_t numBytes) noexcept
+{
+#if defined(__unix__) || defined(__APPLE__)
+    void* memory = mmap(nullptr, numBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    return memory == MAP_FAILED ? nullptr : memory;
+#elif defined(_WIN32)
+    return VirtualAlloc(nullptr, numBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    (void) numBytes;
+    return nullptr;
+#endif
+}
+
+/** Unmaps memory returned by map(). Only safe once nothing can access it anymore (e.g. in a child process). */
+inline void unmap(void* memory, std::size_t numBytes) noexcept
+{
+#if defined(__unix__) || defined(__APPLE__)
+    munmap(memory, numBytes);
+#elif defined(_WIN32)
+    (void) numBytes;
+    VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    (void) memory;
+    (void) numBytes;
+#endif
+}
+} // namespace MemorySentinelArena
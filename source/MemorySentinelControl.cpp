@@ -0,0 +1,510 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include "MemorySentinelControl.hpp"
+#include "MemorySentinel.hpp"
+#include "MemorySentinelOutput.hpp"
+#include "MemorySentinelStatistics.hpp"
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/** Compares the leading word of a command (case-sensitive) and returns a pointer to its argument, or nullptr */
+static const char* matchCommand(const char* command, const char* keyword) noexcept
+{
+    const std::size_t length = strlen(keyword);
+    if (strncmp(command, keyword, length) != 0) {
+        return nullptr;
+    }
+    const char* argument = command + length;
+    if (*argument != '\0' && *argument != ' ') {
+        return nullptr;
+    }
+    while (*argument == ' ') {
+        ++argument;
+    }
+    return argument;
+}
+
+/** Parses a decimal integer in [minValue, INT_MAX]; out-of-range values are rejected rather than truncated */
+static bool parseInt(const char* text, int minValue, int& value) noexcept
+{
+    char* end = nullptr;
+    errno = 0;
+    const long parsed = strtol(text, &end, 10);
+    if (end == text || (*end != '\0' && *end != ' ') || errno == ERANGE || parsed < minValue || parsed > INT_MAX) {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+bool MemorySentinelControl::executeCommand(const char* command, char* reply, std::size_t replySize) noexcept
+{
+    if (command == nullptr || reply == nullptr || replySize == 0) {
+        return false;
+    }
+    const char* argument = nullptr;
+    int value = 0;
+    bool understood = true;
+    bool isArgumentValid = true;
+
+    if (matchCommand(command, "arm")) {
+        MemorySentinel::setDisarmOverride(false);
+        MemorySentinel::getInstance().setArmed(true);
+    } else if (matchCommand(command, "disarm")) {
+        // other threads' scopes hold their own references: only the override disarms the whole process
+        MemorySentinel::getInstance().setArmed(false);
+        MemorySentinel::setDisarmOverride(true);
+    } else if ((argument = matchCommand(command, "behaviour")) != nullptr) {
+        if (strcmp(argument, "log") == 0) {
+            MemorySentinel::setTransgressionBehaviour(MemorySentinel::TransgressionBehaviour::LOG);
+        } else if (strcmp(argument, "throw") == 0) {
+            MemorySentinel::setTransgressionBehaviour(MemorySentinel::TransgressionBehaviour::THROW_EXCEPTION);
+        } else if (strcmp(argument, "silent") == 0) {
+            MemorySentinel::setTransgressionBehaviour(MemorySentinel::TransgressionBehaviour::SILENT);
+        } else {
+            understood = false;
+        }
+    } else if ((argument = matchCommand(command, "quota")) != nullptr) {
+        isArgumentValid = parseInt(argument, 0, value);
+        if (isArgumentValid) {
+            MemorySentinel::setAllocationQuota(value);
+        }
+    } else if ((argument = matchCommand(command, "sampling")) != nullptr) {
+        isArgumentValid = parseInt(argument, 1, value);
+        if (isArgumentValid) {
+            MemorySentinel::setSamplingInterval(value);
+        }
+    } else if ((argument = matchCommand(command, "statistics")) != nullptr &&
+               (strcmp(argument, "on") == 0 || strcmp(argument, "off") == 0)) {
+        MemorySentinel::setStatisticsEnabled(strcmp(argument, "on") == 0);
+    } else if (matchCommand(command, "reset")) {
+        MemorySentinel::resetStatistics();
+    } else if (matchCommand(command, "stats")) {
+        MemorySentinelStatistics::format(reply, replySize);
+        return true;
+    } else if (matchCommand(command, "profile")) {
+        MemorySentinelStatistics::formatHeapProfile(reply, replySize);
+        return true;
+    } else if (matchCommand(command, "reallocs")) {
+        MemorySentinelStatistics::formatTopReallocSites(reply, replySize);
+        return true;
+    } else if (matchCommand(command, "sizes")) {
+        MemorySentinelStatistics::formatSizeClasses(reply, replySize);
+        return true;
+    } else if (matchCommand(command, "tags")) {
+        MemorySentinelStatistics::formatTopTags(reply, replySize);
+        return true;
+    } else {
+        understood = false;
+    }
+
+    if (!understood) {
+        snprintf(reply, replySize, "error: unknown command '%s'\n", command);
+    } else if (!isArgumentValid) {
+        snprintf(reply, replySize, "error: invalid argument '%s'\n", argument);
+    } else {
+        snprintf(reply, replySize, "ok\n");
+    }
+    return understood && isArgumentValid;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Socket server (POSIX only)
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <atomic>
+#include <cerrno>
+#include <mutex>
+
+#include <csignal>
+#include <ctime>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // macOS: SO_NOSIGPIPE is set on the connection instead
+#endif
+
+static std::mutex lifecycleMutex;
+static std::atomic<bool> running { false };
+static std::atomic<bool> stopRequested { false };
+static pthread_t controlThread;
+static int listenFd = -1;
+static int wakePipe[2] = { -1, -1 };
+static char boundSocketPath[sizeof(sockaddr_un::sun_path)] = {};
+
+static void sendAll(int fd, const char* data, std::size_t length) noexcept
+{
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += sent;
+        length -= static_cast<std::size_t>(sent);
+    }
+}
+
+/** A client gets at most this many commands per connection, so a chatty one can't monopolize the channel */
+static constexpr int MAX_COMMANDS_PER_CONNECTION = 64;
+
+/**
+ * Reads newline-separated commands from a connection until the peer closes it, times out, reaches the command limit
+ * or stop() is called.
+ */
+static void serveConnection(int fd) noexcept
+{
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    timeval timeout { 1, 0 }; // don't let a stuck client block the channel
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    char line[256];
+    char reply[4096];
+    std::size_t lineLength = 0;
+    int numCommands = 0;
+    while (!stopRequested.load(std::memory_order_relaxed)) {
+        char c;
+        ssize_t received = recv(fd, &c, 1, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        const bool endOfStream = (received <= 0);
+        if (endOfStream || c == '\n') {
+            if (lineLength > 0 && line[lineLength-1] == '\r') {
+                --lineLength;
+            }
+            line[lineLength] = '\0';
+            if (lineLength > 0) {
+                MemorySentinelControl::executeCommand(line, reply, sizeof(reply));
+                sendAll(fd, reply, strlen(reply));
+                ++numCommands;
+            }
+            lineLength = 0;
+            if (endOfStream || numCommands == MAX_COMMANDS_PER_CONNECTION) {
+                return;
+            }
+        } else if (lineLength < sizeof(line) - 1) {
+            line[lineLength++] = c;
+        }
+    }
+}
+
+static void* controlThreadMain(void*)
+{
+    while (true) {
+        pollfd fds[2] = { { listenFd, POLLIN, 0 }, { wakePipe[0], POLLIN, 0 } };
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break; // stop requested
+        }
+        if (fds[0].revents & POLLIN) {
+#if defined(SOCK_CLOEXEC)
+            int connection = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+#else
+            int connection = accept(listenFd, nullptr, nullptr);
+#endif
+            if (connection >= 0) {
+                serveConnection(connection);
+                close(connection);
+            }
+        }
+    }
+    return nullptr;
+}
+
+static void closeFileDescriptors() noexcept
+{
+    for (int* fd : { &listenFd, &wakePipe[0], &wakePipe[1] }) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+bool MemorySentinelControl::start(const char* socketPath) noexcept
+{
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    if (running.load() || socketPath == nullptr || strlen(socketPath) >= sizeof(boundSocketPath)) {
+        return false;
+    }
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+
+    // remove a stale socket from a previous run, but never delete anything else that happens to live at socketPath
+    struct stat existing;
+    if (lstat(socketPath, &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode) || unlink(socketPath) != 0) {
+            return false;
+        }
+    } else if (errno != ENOENT) {
+        return false;
+    }
+
+#if defined(SOCK_CLOEXEC)
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+#else
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0); // macOS: set below
+#endif
+    if (listenFd < 0 || !MemorySentinelOutput::openPipe(wakePipe) ||
+        bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFd, 4) != 0) {
+        closeFileDescriptors();
+        return false;
+    }
+#if !defined(SOCK_CLOEXEC)
+    fcntl(listenFd, F_SETFD, FD_CLOEXEC);
+#endif
+
+    stopRequested.store(false);
+    if (pthread_create(&controlThread, nullptr, controlThreadMain, nullptr) != 0) {
+        closeFileDescriptors();
+        unlink(socketPath);
+        return false;
+    }
+    strncpy(boundSocketPath, socketPath, sizeof(boundSocketPath) - 1);
+    running.store(true);
+    return true;
+}
+
+void MemorySentinelControl::stop() noexcept
+{
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    if (!running.load()) {
+        return;
+    }
+    stopRequested.store(true); // ends a connection that is being served between two received bytes
+    const char wake = 'x';
+    while (write(wakePipe[1], &wake, 1) < 0 && errno == EINTR) {}
+    pthread_join(controlThread, nullptr);
+    closeFileDescriptors();
+    unlink(boundSocketPath);
+    boundSocketPath[0] = '\0';
+    running.store(false);
+}
+
+bool MemorySentinelControl::isRunning() noexcept
+{
+    return running.load();
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Signal-triggered dump (POSIX only)
+// The signal handler only writes a one-byte code into a self-pipe. The dump thread blocks on the pipe, formats the
+// report into a stack buffer and appends it to the dump file.
+
+enum DumpCode : unsigned char
+{
+    STOP_DUMP_THREAD = 0,
+    DUMP_STATISTICS = 1,
+    DUMP_HEAP_PROFILE = 2,
+};
+
+static std::mutex dumpLifecycleMutex;
+static std::atomic<bool> dumpRunning { false };
+static pthread_t dumpThread;
+static int signalPipe[2] = { -1, -1 };
+static int dumpSignals[2] = { 0, 0 };
+static struct sigaction previousSignalActions[2];
+static char dumpFilePath[1024] = {};
+
+static void onDumpSignal(int signalNumber)
+{
+    const int savedErrno = errno;
+    const unsigned char code = (signalNumber == dumpSignals[1]) ? DUMP_HEAP_PROFILE : DUMP_STATISTICS;
+    ssize_t ignored = write(signalPipe[1], &code, 1); // non-blocking: a dump request is dropped if the pipe is full
+    (void) ignored;
+    errno = savedErrno;
+}
+
+static void writeDump(unsigned char code) noexcept
+{
+    char report[16384];
+    std::size_t position = static_cast<std::size_t>(snprintf(report, sizeof(report),
+                                                             "=== MemorySentinel %s (pid %d, time %lld) ===\n",
+                                                             code == DUMP_HEAP_PROFILE ? "heap profile" : "statistics",
+                                                             static_cast<int>(getpid()),
+                                                             static_cast<long long>(time(nullptr))));
+    if (code == DUMP_HEAP_PROFILE) {
+        position += MemorySentinelStatistics::formatHeapProfile(report + position, sizeof(report) - position);
+    } else {
+        position += MemorySentinelStatistics::format(report + position, sizeof(report) - position);
+    }
+
+    int fd = open(dumpFilePath, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    const char* data = report;
+    while (position > 0) {
+        ssize_t written = write(fd, data, position);
+        if (written <= 0) {
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        data += written;
+        position -= static_cast<std::size_t>(written);
+    }
+    close(fd);
+}
+
+static void* dumpThreadMain(void*)
+{
+    while (true) {
+        unsigned char code;
+        ssize_t received = read(signalPipe[0], &code, 1);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0 || code == STOP_DUMP_THREAD) {
+            break;
+        }
+        writeDump(code);
+    }
+    return nullptr;
+}
+
+static void closeSignalPipe() noexcept
+{
+    for (int& fd : signalPipe) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+}
+
+bool MemorySentinelControl::startSignalDump(const char* filePath) noexcept
+{
+    return startSignalDump(filePath, SIGUSR1, SIGUSR2);
+}
+
+bool MemorySentinelControl::startSignalDump(const char* filePath, int statisticsSignal, int heapProfileSignal) noexcept
+{
+    std::lock_guard<std::mutex> lock(dumpLifecycleMutex);
+    if (dumpRunning.load() || filePath == nullptr || strlen(filePath) >= sizeof(dumpFilePath) ||
+        statisticsSignal == heapProfileSignal) {
+        return false;
+    }
+    if (!MemorySentinelOutput::openPipe(signalPipe)) {
+        return false;
+    }
+    fcntl(signalPipe[1], F_SETFL, O_NONBLOCK);
+    strncpy(dumpFilePath, filePath, sizeof(dumpFilePath) - 1);
+
+    if (pthread_create(&dumpThread, nullptr, dumpThreadMain, nullptr) != 0) {
+        closeSignalPipe();
+        return false;
+    }
+
+    dumpSignals[0] = statisticsSignal;
+    dumpSignals[1] = heapProfileSignal;
+    struct sigaction action {};
+    action.sa_handler = onDumpSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(statisticsSignal, &action, &previousSignalActions[0]);
+    sigaction(heapProfileSignal, &action, &previousSignalActions[1]);
+    dumpRunning.store(true);
+    return true;
+}
+
+void MemorySentinelControl::stopSignalDump() noexcept
+{
+    std::lock_guard<std::mutex> lock(dumpLifecycleMutex);
+    if (!dumpRunning.load()) {
+        return;
+    }
+    sigaction(dumpSignals[0], &previousSignalActions[0], nullptr);
+    sigaction(dumpSignals[1], &previousSignalActions[1], nullptr);
+
+    const unsigned char stop = STOP_DUMP_THREAD;
+    fcntl(signalPipe[1], F_SETFL, 0); // the stop request must not be dropped
+    while (write(signalPipe[1], &stop, 1) < 0 && errno == EINTR) {}
+    pthread_join(dumpThread, nullptr);
+    closeSignalPipe();
+    dumpRunning.store(false);
+}
+
+bool MemorySentinelControl::isSignalDumpRunning() noexcept
+{
+    return dumpRunning.load();
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Fork handlers
+void MemorySentinelControl::prepareFork() noexcept
+{
+    lifecycleMutex.lock();
+    dumpLifecycleMutex.lock();
+}
+
+void MemorySentinelControl::parentAfterFork() noexcept
+{
+    dumpLifecycleMutex.unlock();
+    lifecycleMutex.unlock();
+}
+
+void MemorySentinelControl::childAfterFork() noexcept
+{
+    // the socket belongs to the parent: only the child's copies of the descriptors are closed
+    if (running.load()) {
+        closeFileDescriptors();
+        boundSocketPath[0] = '\0';
+        running.store(false);
+    }
+    if (dumpRunning.load()) {
+        sigaction(dumpSignals[0], &previousSignalActions[0], nullptr);
+        sigaction(dumpSignals[1], &previousSignalActions[1], nullptr);
+        closeSignalPipe();
+        dumpRunning.store(false);
+    }
+    dumpLifecycleMutex.unlock();
+    lifecycleMutex.unlock();
+}
+
+#else // POSIX
+
+bool MemorySentinelControl::start(const char*) noexcept { return false; }
+void MemorySentinelControl::stop() noexcept {}
+bool MemorySentinelControl::isRunning() noexcept { return false; }
+bool MemorySentinelControl::startSignalDump(const char*) noexcept { return false; }
+bool MemorySentinelControl::startSignalDump(const char*, int, int) noexcept { return false; }
+void MemorySentinelControl::stopSignalDump() noexcept {}
+bool MemorySentinelControl::isSignalDumpRunning() noexcept { return false; }
+void MemorySentinelControl::prepareFork() noexcept {}
+void MemorySentinelControl::parentAfterFork() noexcept {}
+void MemorySentinelControl::childAfterFork() noexcept {}
+
+#endif // POSIX
@@ -0,0 +1,72 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Opt-in runtime control channel: a background thread listens on a local Unix domain socket and accepts
+ * line-based commands to reconfigure the MemorySentinel of a live process (POSIX only).
+ *
+ *   arm | disarm                      arm / disarm the sentinel process-wide (see MemorySentinel::setDisarmOverride)
+ *   behaviour <log|throw|silent>      set the TransgressionBehaviour
+ *   quota <bytes>                     set the allocation quota
+ *   statistics <on|off>               enable / disable statistics
+ *   sampling <n>                      record every n-th allocation in the statistics
+ *   reset                             reset the statistics counters
+ *   stats                             dump the statistics
+ *   profile                           dump the statistics, live heap summary and top allocating call sites
+ *   reallocs                          dump the realloc call sites with the most small-step growths
+ *   sizes                             dump the requested size histogram and suggested slab size classes
+ *   tags                              dump the top offending scope tags
+ *
+ * The control thread does not allocate while serving commands. Start it while the sentinel is unarmed.
+ * Clients are served one at a time, each for at most 64 commands per connection.
+ * e.g.: echo stats | nc -U /tmp/sentinel.sock
+ */
+class MemorySentinelControl
+{
+public:
+    /**
+     * Starts the control thread listening on socketPath. A stale socket at socketPath is replaced.
+     * Returns false if unsupported, already running, or if anything other than a socket exists at socketPath.
+     */
+    static bool start(const char* socketPath) noexcept;
+
+    /** Stops the control thread (if running) and removes the socket file */
+    static void stop() noexcept;
+
+    static bool isRunning() noexcept;
+
+    /**
+     * Executes a single command (as received over the socket) and writes the reply into reply.
+     * @return true if the command was understood
+     */
+    static bool executeCommand(const char* command, char* reply, std::size_t replySize) noexcept;
+
+    /**
+     * Installs handlers for statisticsSignal (dumps the counters) and heapProfileSignal (dumps counters, live heap
+     * summary and top call sites). The handlers only write to a self-pipe (async-signal-safe); formatting and file
+     * I/O happen on a dedicated thread. Each dump is appended to filePath.
+     * The overload without signals uses SIGUSR1 / SIGUSR2.
+     * @return false if unsupported or already running
+     */
+    static bool startSignalDump(const char* filePath) noexcept;
+    static bool startSignalDump(const char* filePath, int statisticsSignal, int heapProfileSignal) noexcept;
+
+    /** Restores the previous signal handlers and stops the dump thread */
+    static void stopSignalDump() noexcept;
+
+    static bool isSignalDumpRunning() noexcept;
+
+    /** Fork handlers (see MemorySentinel::installForkHandlers): the child has no control or dump thread, it is reset to stopped */
+    static void prepareFork() noexcept;
+    static void parentAfterFork() noexcept;
+    static void childAfterFork() noexcept;
+};
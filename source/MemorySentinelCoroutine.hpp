@@ -0,0 +1,123 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include "MemorySentinel.hpp"
+#include "MemorySentinelAllocator.hpp"
+
+// Only available when compiling at C++20 (or later) with coroutine support, the rest of the library is C++14
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/** Frame allocations of one coroutine (promise) type, see SentinelPromiseMixin */
+struct SentinelCoroutineFrameStatistics
+{
+    std::uint64_t frames = 0;       ///< frames allocated on the heap (i.e. not elided)
+    std::uint64_t frameBytes = 0;
+    std::uint64_t liveFrames = 0;
+    std::uint64_t maxFrameSize = 0;
+};
+
+/** Coroutine frames allocated on the heap by the calling thread (any type with SentinelPromiseMixin) */
+inline thread_local std::uint64_t sentinelCoroutineFramesOfThisThread = 0;
+
+/**
+ * Mixin for the promise type of a coroutine, which then allocates its frames through the sentinel's monitored
+ * allocation: while armed, a frame allocation is subject to the scope's quota and behaviour like any other, and it is
+ * reported as "coroutine frame [<promise type>]" in the per-tag statistics (while statistics are enabled). The counts
+ * and sizes of the frames of each promise type are always kept.
+ *
+ *   struct Task::promise_type : SentinelPromiseMixin<Task::promise_type> { ... };
+ */
+template<class Promise>
+struct SentinelPromiseMixin
+{
+    static void* operator new(std::size_t size)
+    {
+        void* frame = MemorySentinel::allocateMonitored(size, alignof(std::max_align_t), SLB_RETURN_ADDRESS(),
+                                                        &allocateFrame, nullptr, getTagIndex());
+        s_frames.fetch_add(1, std::memory_order_relaxed);
+        s_frameBytes.fetch_add(size, std::memory_order_relaxed);
+        s_liveFrames.fetch_add(1, std::memory_order_relaxed);
+        std::uint64_t maxFrameSize = s_maxFrameSize.load(std::memory_order_relaxed);
+        while (maxFrameSize < size && !s_maxFrameSize.compare_exchange_weak(maxFrameSize, size, std::memory_order_relaxed)) {}
+        ++sentinelCoroutineFramesOfThisThread;
+        return frame;
+    }
+
+    static void operator delete(void* frame, std::size_t size)
+    {
+        s_liveFrames.fetch_sub(1, std::memory_order_relaxed);
+        MemorySentinel::deallocateMonitored(frame, size, alignof(std::max_align_t), SLB_RETURN_ADDRESS(), &deallocateFrame, nullptr);
+    }
+
+    static SentinelCoroutineFrameStatistics getFrameStatistics() noexcept
+    {
+        SentinelCoroutineFrameStatistics result;
+        result.frames = s_frames.load(std::memory_order_relaxed);
+        result.frameBytes = s_frameBytes.load(std::memory_order_relaxed);
+        result.liveFrames = s_liveFrames.load(std::memory_order_relaxed);
+        result.maxFrameSize = s_maxFrameSize.load(std::memory_order_relaxed);
+        return result;
+    }
+
+private:
+    static int getTagIndex() noexcept
+    {
+        static const int tagIndex = MemorySentinel::internTag("coroutine frame", MemorySentinelTypeName<Promise>::get());
+        return tagIndex;
+    }
+
+    static void* allocateFrame(void*, std::size_t size, std::size_t) { return ::operator new(size); }
+    static void deallocateFrame(void*, void* frame, std::size_t, std::size_t) { ::operator delete(frame); }
+
+    static inline std::atomic<std::uint64_t> s_frames { 0 };
+    static inline std::atomic<std::uint64_t> s_frameBytes { 0 };
+    static inline std::atomic<std::uint64_t> s_liveFrames { 0 };
+    static inline std::atomic<std::uint64_t> s_maxFrameSize { 0 };
+};
+
+/**
+ * Checks that the coroutines started by this thread within the scope (e.g. an armed hot path) had their frames
+ * elided, i.e. that none of them was allocated on the heap. Upon exit, asserts if a frame was allocated (unless
+ * assertOnExit is false). Only coroutines whose promise type uses SentinelPromiseMixin are seen.
+ */
+class ScopedCoroutineElisionCheck
+{
+public:
+    explicit ScopedCoroutineElisionCheck(bool assertOnExit = true) noexcept
+        : m_initialFrames(sentinelCoroutineFramesOfThisThread)
+        , m_assertOnExit(assertOnExit)
+    {}
+
+    ~ScopedCoroutineElisionCheck()
+    {
+        if (m_assertOnExit && getFrameAllocations() > 0) {
+            assert(false && "MemorySentinel: coroutine frame was not elided!");
+        }
+    }
+
+    /** Frames allocated on the heap by this thread since the scope was entered */
+    std::uint64_t getFrameAllocations() const noexcept { return sentinelCoroutineFramesOfThisThread - m_initialFrames; }
+
+    ScopedCoroutineElisionCheck(const ScopedCoroutineElisionCheck&) = delete;                   ///< Copy ctor
+    ScopedCoroutineElisionCheck& operator= (const ScopedCoroutineElisionCheck&) = delete;       ///< Copy assignment operator
+
+private:
+    std::uint64_t m_initialFrames;
+    bool m_assertOnExit;
+};
+
+#endif // __has_include(<coroutine>)
+#endif // __cpp_impl_coroutine
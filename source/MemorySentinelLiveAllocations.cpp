@@ -0,0 +1,531 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include "MemorySentinelLiveAllocations.hpp"
+#include "MemorySentinelArena.hpp"
+#include "MemorySentinelOutput.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#if defined(__clang__) || defined(__GNUC__)
+    #include <dlfcn.h>
+#endif
+#if defined(__GLIBC__) || defined(__APPLE__)
+    #include <execinfo.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using MemorySentinelOutput::writeLine;
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Arena layout
+// Live blocks: open-addressing table keyed by address. Slots are claimed with a CAS (EMPTY/TOMBSTONE -> BUSY), filled
+// and then published with the address; freeing a block leaves a tombstone. A block address is unique while it is
+// alive, so reusing tombstones cannot create duplicates. Blocks that find no slot within MAX_LIVE_PROBES are dropped.
+// Stacks: interned by hash like the call sites in MemorySentinelStatistics; stacks that find no slot are reported as
+// unknown. The totals and order arrays are scratch space for the (serialized) report, which is only approximate while
+// other threads keep allocating.
+static constexpr std::uintptr_t EMPTY_SLOT = 0;
+static constexpr std::uintptr_t TOMBSTONE_SLOT = 1;
+static constexpr std::uintptr_t BUSY_SLOT = 2;
+
+struct LiveEntry
+{
+    std::atomic<std::uintptr_t> address;
+    std::uint64_t size;
+    std::uint32_t stackIndex;
+    std::int32_t tagIndex;
+    std::uintptr_t callSite;
+    std::uint64_t timestampNs;
+};
+
+struct StackEntry
+{
+    std::atomic<std::uint64_t> hash; // 0 = empty
+    std::atomic<bool> ready;
+    std::uint32_t depth;
+    const void* frames[MemorySentinelLiveAllocations::MAX_STACK_DEPTH];
+};
+
+struct StackTotal
+{
+    std::uint64_t blocks;
+    std::uint64_t bytes;
+};
+
+static constexpr std::size_t NUM_LIVE_ENTRIES = 1 << 18; // must be a power of two
+static constexpr std::size_t MAX_LIVE_PROBES = 64;
+static constexpr std::size_t NUM_STACKS = 1 << 14;       // must be a power of two
+static constexpr std::size_t MAX_STACK_PROBES = 32;
+static constexpr std::uint32_t UNKNOWN_STACK = NUM_STACKS;
+
+// Lifetimes: per-call-site histograms, in a table like the call sites in MemorySentinelStatistics
+struct LifetimeEntry
+{
+    std::atomic<std::uintptr_t> callSite;
+    std::atomic<std::uint64_t> frees;
+    std::atomic<std::uint64_t> totalLifetimeNs;
+    std::atomic<std::uint64_t> buckets[MemorySentinel::NUM_LIFETIME_BUCKETS];
+};
+
+static constexpr std::size_t NUM_LIFETIME_CALL_SITES = 1024; // must be a power of two
+static constexpr std::size_t MAX_LIFETIME_PROBES = 32;
+
+// The arena pages are zero-initialized, which is the initial state of all of these (trivial) members
+struct LiveAllocationArena
+{
+    LiveEntry live[NUM_LIVE_ENTRIES];
+    StackEntry stacks[NUM_STACKS];
+    LifetimeEntry lifetimes[NUM_LIFETIME_CALL_SITES + 1]; // the last one collects call sites that found no entry
+    StackTotal totals[NUM_STACKS + 1];
+    std::uint32_t order[NUM_STACKS + 1];
+};
+
+static std::atomic<LiveAllocationArena*> liveArena { nullptr };
+static std::atomic<std::uint64_t> droppedAllocations { 0 };
+static std::mutex liveArenaMutex; // serializes initialization and reports
+
+bool MemorySentinelLiveAllocations::initialize() noexcept
+{
+    std::lock_guard<std::mutex> lock(liveArenaMutex);
+    if (liveArena.load() != nullptr) {
+        return true;
+    }
+#if defined(__GLIBC__) || defined(__APPLE__)
+    void* frames[1];
+    backtrace(frames, 1); // backtrace() loads its unwinder on first use: do it now, not within an allocation
+#endif
+    liveArena.store(static_cast<LiveAllocationArena*>(MemorySentinelArena::map(sizeof(LiveAllocationArena))));
+    return liveArena.load() != nullptr;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Recording
+
+static std::size_t hashAddress(std::uintptr_t address) noexcept
+{
+    return static_cast<std::size_t>((static_cast<std::uint64_t>(address >> 4) * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+static std::uint64_t nowNs() noexcept
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/** Bucket i counts lifetimes in [2^i, 2^(i+1)) ns (bucket 0 also counts 0 ns, the last one everything longer) */
+static std::size_t lifetimeBucket(std::uint64_t lifetimeNs) noexcept
+{
+    std::size_t bucket = 0;
+    while ((lifetimeNs >>= 1) != 0 && bucket < MemorySentinel::NUM_LIFETIME_BUCKETS - 1) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+static void recordLifetime(LiveAllocationArena& arena, std::uintptr_t callSite, std::uint64_t lifetimeNs) noexcept
+{
+    LifetimeEntry* histogram = &arena.lifetimes[NUM_LIFETIME_CALL_SITES];
+    const std::size_t index = hashAddress(callSite);
+    for (std::size_t probe = 0; probe < MAX_LIFETIME_PROBES && callSite != 0; ++probe) {
+        LifetimeEntry& entry = arena.lifetimes[(index + probe) & (NUM_LIFETIME_CALL_SITES - 1)];
+        std::uintptr_t current = entry.callSite.load(std::memory_order_acquire);
+        if (current == callSite ||
+            (current == 0 && (entry.callSite.compare_exchange_strong(current, callSite, std::memory_order_acq_rel) || current == callSite))) {
+            histogram = &entry;
+            break;
+        }
+    }
+    histogram->frees.fetch_add(1, std::memory_order_relaxed);
+    histogram->totalLifetimeNs.fetch_add(lifetimeNs, std::memory_order_relaxed);
+    histogram->buckets[lifetimeBucket(lifetimeNs)].fetch_add(1, std::memory_order_relaxed);
+}
+
+static std::uint32_t internStack(LiveAllocationArena& arena, const void* const* frames, std::uint32_t depth) noexcept
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull; // FNV-1a over the frame addresses
+    for (std::uint32_t i = 0; i < depth; ++i) {
+        hash = (hash ^ reinterpret_cast<std::uintptr_t>(frames[i])) * 0x100000001b3ull;
+    }
+    hash |= 1; // 0 marks empty slots
+    for (std::size_t probe = 0; probe < MAX_STACK_PROBES; ++probe) {
+        const std::size_t slot = (static_cast<std::size_t>(hash >> 20) + probe) & (NUM_STACKS - 1);
+        StackEntry& entry = arena.stacks[slot];
+        std::uint64_t current = entry.hash.load(std::memory_order_acquire);
+        if (current == 0 && entry.hash.compare_exchange_strong(current, hash, std::memory_order_acq_rel)) {
+            entry.depth = depth;
+            std::copy(frames, frames + depth, entry.frames);
+            entry.ready.store(true, std::memory_order_release);
+            return static_cast<std::uint32_t>(slot);
+        }
+        if (current == hash) {
+            return static_cast<std::uint32_t>(slot);
+        }
+    }
+    return UNKNOWN_STACK;
+}
+
+static std::uint32_t captureStack(LiveAllocationArena& arena, const void* returnAddress) noexcept
+{
+    const void* frames[MemorySentinelLiveAllocations::MAX_STACK_DEPTH + 8];
+    std::uint32_t depth = 0;
+#if defined(__GLIBC__) || defined(__APPLE__)
+    depth = static_cast<std::uint32_t>(backtrace(const_cast<void**>(frames), static_cast<int>(sizeof(frames) / sizeof(frames[0]))));
+#endif
+    // skip the sentinel's own frames: the recorded stack starts at the caller of the allocation function
+    std::uint32_t first = 0;
+    while (first < depth && frames[first] != returnAddress) {
+        ++first;
+    }
+    if (first == depth) {
+        frames[0] = returnAddress;
+        first = 0;
+        depth = 1;
+    }
+    depth = std::min<std::uint32_t>(depth - first, MemorySentinelLiveAllocations::MAX_STACK_DEPTH);
+    return internStack(arena, frames + first, depth);
+}
+
+void MemorySentinelLiveAllocations::recordAllocation(const void* ptr, std::size_t size, const void* returnAddress, int tagIndex) noexcept
+{
+    LiveAllocationArena* arena = liveArena.load(std::memory_order_acquire);
+    const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+    if (arena == nullptr || address <= BUSY_SLOT) {
+        return;
+    }
+    const std::size_t index = hashAddress(address);
+    for (std::size_t probe = 0; probe < MAX_LIVE_PROBES; ++probe) {
+        LiveEntry& entry = arena->live[(index + probe) & (NUM_LIVE_ENTRIES - 1)];
+        std::uintptr_t current = entry.address.load(std::memory_order_relaxed);
+        if ((current == EMPTY_SLOT || current == TOMBSTONE_SLOT) &&
+            entry.address.compare_exchange_strong(current, BUSY_SLOT, std::memory_order_acquire)) {
+            entry.size = size;
+            entry.tagIndex = tagIndex;
+            entry.stackIndex = captureStack(*arena, returnAddress);
+            entry.callSite = reinterpret_cast<std::uintptr_t>(returnAddress);
+            entry.timestampNs = nowNs();
+            entry.address.store(address, std::memory_order_release);
+            return;
+        }
+    }
+    droppedAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemorySentinelLiveAllocations::recordDeallocation(const void* ptr) noexcept
+{
+    LiveAllocationArena* arena = liveArena.load(std::memory_order_acquire);
+    const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+    if (arena == nullptr || address <= BUSY_SLOT) {
+        return;
+    }
+    const std::size_t index = hashAddress(address);
+    for (std::size_t probe = 0; probe < MAX_LIVE_PROBES; ++probe) {
+        LiveEntry& entry = arena->live[(index + probe) & (NUM_LIVE_ENTRIES - 1)];
+        std::uintptr_t current = entry.address.load(std::memory_order_acquire);
+        if (current == address) {
+            // claim the slot before reading it: of two racing deallocations of the same address, only one records it,
+            // and the slot can't be reused (and its fields overwritten) until it is released as a tombstone
+            if (!entry.address.compare_exchange_strong(current, BUSY_SLOT, std::memory_order_acquire)) {
+                return;
+            }
+            const std::uint64_t timestampNs = entry.timestampNs;
+            const std::uintptr_t callSite = entry.callSite;
+            entry.address.store(TOMBSTONE_SLOT, std::memory_order_release);
+            const std::uint64_t now = nowNs();
+            recordLifetime(*arena, callSite, now > timestampNs ? now - timestampNs : 0);
+            return;
+        }
+        if (current == EMPTY_SLOT) {
+            return; // not tracked (e.g. allocated before tracking was enabled)
+        }
+    }
+}
+
+std::size_t MemorySentinelLiveAllocations::findSize(const void* ptr) noexcept
+{
+    LiveAllocationArena* arena = liveArena.load(std::memory_order_acquire);
+    const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+    if (arena == nullptr || address <= BUSY_SLOT) {
+        return 0;
+    }
+    const std::size_t index = hashAddress(address);
+    for (std::size_t probe = 0; probe < MAX_LIVE_PROBES; ++probe) {
+        const LiveEntry& entry = arena->live[(index + probe) & (NUM_LIVE_ENTRIES - 1)];
+        const std::uintptr_t current = entry.address.load(std::memory_order_acquire);
+        if (current == address) {
+            return static_cast<std::size_t>(entry.size);
+        }
+        if (current == EMPTY_SLOT) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Report
+
+static void writeFrame(int fileDescriptor, const void* frame) noexcept
+{
+    const char* symbol = "?";
+    const char* module = "?";
+    std::uintptr_t offset = 0;
+#if defined(__clang__) || defined(__GNUC__)
+    Dl_info info;
+    if (dladdr(frame, &info) != 0) {
+        module = info.dli_fname != nullptr ? info.dli_fname : module;
+        if (info.dli_sname != nullptr) {
+            symbol = info.dli_sname;
+            offset = reinterpret_cast<std::uintptr_t>(frame) - reinterpret_cast<std::uintptr_t>(info.dli_saddr);
+        } else {
+            offset = reinterpret_cast<std::uintptr_t>(frame) - reinterpret_cast<std::uintptr_t>(info.dli_fbase);
+        }
+    }
+#endif
+    writeLine(fileDescriptor, "      %p %s+0x%llx (%s)\n", frame, symbol, static_cast<unsigned long long>(offset), module);
+}
+
+std::size_t MemorySentinelLiveAllocations::writeLeakReport(int fileDescriptor, int tagIndex) noexcept
+{
+    std::lock_guard<std::mutex> lock(liveArenaMutex);
+    LiveAllocationArena* arena = liveArena.load();
+    if (arena == nullptr) {
+        return 0;
+    }
+    
+    // group the live blocks by stack
+    std::fill(arena->totals, arena->totals + NUM_STACKS + 1, StackTotal { 0, 0 });
+    std::uint64_t totalBlocks = 0;
+    std::uint64_t totalBytes = 0;
+    for (const LiveEntry& entry : arena->live) {
+        if (entry.address.load(std::memory_order_acquire) <= BUSY_SLOT || (tagIndex >= 0 && entry.tagIndex != tagIndex)) {
+            continue;
+        }
+        StackTotal& total = arena->totals[entry.stackIndex <= UNKNOWN_STACK ? entry.stackIndex : UNKNOWN_STACK];
+        total.blocks++;
+        total.bytes += entry.size;
+        totalBlocks++;
+        totalBytes += entry.size;
+    }
+    std::size_t numStacks = 0;
+    for (std::uint32_t stack = 0; stack <= UNKNOWN_STACK; ++stack) {
+        if (arena->totals[stack].blocks > 0) {
+            arena->order[numStacks++] = stack;
+        }
+    }
+    std::sort(arena->order, arena->order + numStacks, [arena](std::uint32_t a, std::uint32_t b) {
+        return arena->totals[a].bytes > arena->totals[b].bytes;
+    });
+    
+    writeLine(fileDescriptor, "[MemorySentinel] leak report: %llu blocks, %llu bytes still alive (%zu stacks)\n",
+              static_cast<unsigned long long>(totalBlocks), static_cast<unsigned long long>(totalBytes), numStacks);
+    const std::uint64_t dropped = droppedAllocations.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+        writeLine(fileDescriptor, "  (%llu allocations were not tracked: live allocation table full)\n",
+                  static_cast<unsigned long long>(dropped));
+    }
+    for (std::size_t i = 0; i < numStacks; ++i) {
+        const std::uint32_t stack = arena->order[i];
+        writeLine(fileDescriptor, "  #%zu %llu bytes in %llu blocks\n", i + 1,
+                  static_cast<unsigned long long>(arena->totals[stack].bytes),
+                  static_cast<unsigned long long>(arena->totals[stack].blocks));
+        const StackEntry* entry = stack < UNKNOWN_STACK ? &arena->stacks[stack] : nullptr;
+        if (entry == nullptr || !entry->ready.load(std::memory_order_acquire)) {
+            writeLine(fileDescriptor, "      (unknown stack)\n");
+            continue;
+        }
+        for (std::uint32_t frame = 0; frame < entry->depth; ++frame) {
+            writeFrame(fileDescriptor, entry->frames[frame]);
+        }
+    }
+    return static_cast<std::size_t>(totalBlocks);
+}
+
+// MARK: Lifetimes
+
+static void readLifetimeEntry(const LifetimeEntry& entry, MemorySentinel::LifetimeHistogram& histogram) noexcept
+{
+    histogram.address = reinterpret_cast<const void*>(entry.callSite.load(std::memory_order_acquire));
+    histogram.frees = entry.frees.load(std::memory_order_relaxed);
+    histogram.totalLifetimeNs = entry.totalLifetimeNs.load(std::memory_order_relaxed);
+    for (std::size_t bucket = 0; bucket < MemorySentinel::NUM_LIFETIME_BUCKETS; ++bucket) {
+        histogram.buckets[bucket] = entry.buckets[bucket].load(std::memory_order_relaxed);
+    }
+}
+
+std::size_t MemorySentinelLiveAllocations::readLifetimeHistograms(MemorySentinel::LifetimeHistogram* result, std::size_t maxCount) noexcept
+{
+    LiveAllocationArena* arena = liveArena.load(std::memory_order_acquire);
+    if (result == nullptr || arena == nullptr) {
+        return 0;
+    }
+    // insertion into a sorted top-N list (by frees)
+    std::size_t count = 0;
+    for (const LifetimeEntry& entry : arena->lifetimes) {
+        MemorySentinel::LifetimeHistogram candidate;
+        readLifetimeEntry(entry, candidate);
+        if (candidate.frees == 0) {
+            continue;
+        }
+        std::size_t position = count;
+        while (position > 0 && result[position-1].frees < candidate.frees) {
+            if (position < maxCount) {
+                result[position] = result[position-1];
+            }
+            --position;
+        }
+        if (position < maxCount) {
+            result[position] = candidate;
+            count = count < maxCount ? count + 1 : maxCount;
+        }
+    }
+    return count;
+}
+
+void MemorySentinelLiveAllocations::resetLifetimeHistograms() noexcept
+{
+    LiveAllocationArena* arena = liveArena.load(std::memory_order_acquire);
+    if (arena == nullptr) {
+        return;
+    }
+    for (LifetimeEntry& entry : arena->lifetimes) {
+        entry.frees.store(0, std::memory_order_relaxed);
+        entry.totalLifetimeNs.store(0, std::memory_order_relaxed);
+        for (auto& bucket : entry.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+/** Human-readable lower bound of a lifetime bucket */
+static void formatDuration(char* buffer, std::size_t bufferSize, std::uint64_t ns) noexcept
+{
+    if (ns < 1000) {
+        snprintf(buffer, bufferSize, "%lluns", static_cast<unsigned long long>(ns));
+    } else if (ns < 1000000) {
+        snprintf(buffer, bufferSize, "%.1fus", static_cast<double>(ns) / 1e3);
+    } else if (ns < 1000000000) {
+        snprintf(buffer, bufferSize, "%.1fms", static_cast<double>(ns) / 1e6);
+    } else {
+        snprintf(buffer, bufferSize, "%.1fs", static_cast<double>(ns) / 1e9);
+    }
+}
+
+std::size_t MemorySentinelLiveAllocations::writeLifetimeReport(int fileDescriptor, std::size_t numCallSites) noexcept
+{
+    static constexpr std::size_t MAX_REPORTED_CALL_SITES = 32;
+    MemorySentinel::LifetimeHistogram top[MAX_REPORTED_CALL_SITES];
+    numCallSites = std::min(numCallSites, MAX_REPORTED_CALL_SITES);
+    const std::size_t count = readLifetimeHistograms(top, numCallSites);
+    
+    writeLine(fileDescriptor, "[MemorySentinel] object lifetimes of the top %zu call sites (by frees):\n", count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const MemorySentinel::LifetimeHistogram& histogram = top[i];
+        char mean[32];
+        formatDuration(mean, sizeof(mean), histogram.totalLifetimeNs / histogram.frees);
+        writeLine(fileDescriptor, "  #%zu %llu frees, mean lifetime %s\n", i + 1,
+                  static_cast<unsigned long long>(histogram.frees), mean);
+        if (histogram.address != nullptr) {
+            writeFrame(fileDescriptor, histogram.address);
+        } else {
+            writeLine(fileDescriptor, "      (unknown call site)\n");
+        }
+        for (std::size_t bucket = 0; bucket < MemorySentinel::NUM_LIFETIME_BUCKETS; ++bucket) {
+            if (histogram.buckets[bucket] == 0) {
+                continue;
+            }
+            char lowerBound[32];
+            formatDuration(lowerBound, sizeof(lowerBound), bucket == 0 ? 0 : (1ull << bucket));
+            writeLine(fileDescriptor, "      >= %-8s %llu\n", lowerBound, static_cast<unsigned long long>(histogram.buckets[bucket]));
+        }
+    }
+    return count;
+}
+
+// MARK: At exit
+// A destructor function runs after the atexit handlers and static destructors, i.e. when everything that is still
+// alive has actually leaked.
+static std::atomic<bool> isLeakReportAtExitEnabled { false };
+static char leakReportPath[256];
+static int leakReportTagIndex = -1;
+
+static void writePendingLeakReport() noexcept
+{
+    if (!isLeakReportAtExitEnabled.exchange(false)) {
+        return;
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    int fileDescriptor = STDERR_FILENO;
+    if (leakReportPath[0] != '\0') {
+        fileDescriptor = open(leakReportPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fileDescriptor < 0) {
+            return;
+        }
+    }
+    MemorySentinelLiveAllocations::writeLeakReport(fileDescriptor, leakReportTagIndex);
+    if (fileDescriptor != STDERR_FILENO) {
+        close(fileDescriptor);
+    }
+#endif
+}
+
+#if defined(__clang__) || defined(__GNUC__)
+__attribute__((destructor)) static void writeLeakReportAtUnload() noexcept
+{
+    writePendingLeakReport();
+}
+#endif
+
+bool MemorySentinelLiveAllocations::writeLeakReportAtExit(const char* path, int tagIndex) noexcept
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if (!initialize() || (path != nullptr && strlen(path) >= sizeof(leakReportPath))) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(liveArenaMutex);
+    strcpy(leakReportPath, path != nullptr ? path : "");
+    leakReportTagIndex = tagIndex;
+    isLeakReportAtExitEnabled.store(true);
+    return true;
+#else
+    (void) path;
+    (void) tagIndex;
+    return false;
+#endif
+}
+
+void MemorySentinelLiveAllocations::prepareFork() noexcept
+{
+    liveArenaMutex.lock();
+}
+
+void MemorySentinelLiveAllocations::parentAfterFork() noexcept
+{
+    liveArenaMutex.unlock();
+}
+
+void MemorySentinelLiveAllocations::childAfterFork() noexcept
+{
+    if (LiveAllocationArena* arena = liveArena.load()) {
+        liveArena.store(static_cast<LiveAllocationArena*>(MemorySentinelArena::map(sizeof(LiveAllocationArena))));
+        MemorySentinelArena::unmap(arena, sizeof(LiveAllocationArena)); // only this thread survived the fork
+    }
+    droppedAllocations.store(0);
+    isLeakReportAtExitEnabled.store(false);
+    liveArenaMutex.unlock();
+}
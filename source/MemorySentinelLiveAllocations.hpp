@@ -0,0 +1,64 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include "MemorySentinel.hpp"
+
+#include <cstddef>
+
+/**
+ * Opt-in table of live (not yet freed) allocations: address -> size, allocating stack, scope tag and timestamp.
+ * When a tracked block is freed, its lifetime is added to the lifetime histogram of its call site.
+ * The table lives in the sentinel's private arena (see MemorySentinelArena), so it does not use the process heap it
+ * observes. All functions are allocation-free, so they can be called from within new/delete and malloc/free.
+ */
+class MemorySentinelLiveAllocations
+{
+public:
+    static constexpr std::size_t MAX_STACK_DEPTH = 8;
+
+    /** Maps the arena on first call. Returns false if not supported on this platform. */
+    static bool initialize() noexcept;
+
+    /**
+     * @param returnAddress return address of the allocation function (the recorded stack starts there)
+     * @param tagIndex tag slot of the innermost scope (-1: none)
+     */
+    static void recordAllocation(const void* ptr, std::size_t size, const void* returnAddress, int tagIndex) noexcept;
+    static void recordDeallocation(const void* ptr) noexcept;
+
+    /** Requested size of a tracked live block (0 if not tracked) */
+    static std::size_t findSize(const void* ptr) noexcept;
+
+    /**
+     * Writes the blocks still alive, grouped by allocating stack and sorted by total bytes, to a file descriptor.
+     * @param tagIndex only report blocks allocated within scopes with this tag slot (-1: all)
+     * @return the number of reported blocks
+     */
+    static std::size_t writeLeakReport(int fileDescriptor, int tagIndex) noexcept;
+
+    /** Fills result with up to maxCount lifetime histograms, sorted by frees (descending) */
+    static std::size_t readLifetimeHistograms(MemorySentinel::LifetimeHistogram* result, std::size_t maxCount) noexcept;
+    static void resetLifetimeHistograms() noexcept;
+
+    /** Writes the lifetime histograms of the call sites with the most frees. Returns the number of call sites written. */
+    static std::size_t writeLifetimeReport(int fileDescriptor, std::size_t numCallSites) noexcept;
+
+    /** Writes the leak report to path (nullptr: stderr) when the process exits, after static destructors have run */
+    static bool writeLeakReportAtExit(const char* path, int tagIndex) noexcept;
+
+    /**
+     * Fork handlers (see MemorySentinel::installForkHandlers): no initialization or report is in progress while
+     * forking. The child starts with an empty table and without a leak report at exit (which would overwrite the
+     * parent's): the inherited blocks were allocated by the parent, and other threads may have been filling slots.
+     */
+    static void prepareFork() noexcept;
+    static void parentAfterFork() noexcept;
+    static void childAfterFork() noexcept;
+};
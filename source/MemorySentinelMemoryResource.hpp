@@ -0,0 +1,70 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include "MemorySentinel.hpp"
+
+// Only available when compiling at C++17 (or later), the rest of the library is C++14
+#if (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)) && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+
+/**
+ * std::pmr::memory_resource that monitors the allocations of an upstream resource like the global hooks do: while
+ * the sentinel is armed, they are subject to the same allowlist, scopes, quotas and transgression behaviours, and
+ * they are recorded in the statistics. Resources that don't use the heap, like a std::pmr::monotonic_buffer_resource
+ * on a stack buffer, thus become visible to the sentinel (and the allocations of an upstream that does use the heap
+ * are not counted twice).
+ *
+ *   std::pmr::monotonic_buffer_resource buffer(storage, sizeof(storage), std::pmr::null_memory_resource());
+ *   SentinelMemoryResource sentinel(&buffer);
+ *   std::pmr::vector<float> samples(&sentinel);
+ */
+class SentinelMemoryResource : public std::pmr::memory_resource
+{
+public:
+    explicit SentinelMemoryResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+        : m_upstream(upstream)
+    {
+        assert(upstream != nullptr);
+    }
+
+    std::pmr::memory_resource* upstream_resource() const noexcept { return m_upstream; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        return MemorySentinel::allocateMonitored(bytes, alignment, SLB_RETURN_ADDRESS(), &allocateUpstream, m_upstream);
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+    {
+        MemorySentinel::deallocateMonitored(ptr, bytes, alignment, SLB_RETURN_ADDRESS(), &deallocateUpstream, m_upstream);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    static void* allocateUpstream(void* upstream, std::size_t bytes, std::size_t alignment)
+    {
+        return static_cast<std::pmr::memory_resource*>(upstream)->allocate(bytes, alignment);
+    }
+
+    static void deallocateUpstream(void* upstream, void* ptr, std::size_t bytes, std::size_t alignment)
+    {
+        static_cast<std::pmr::memory_resource*>(upstream)->deallocate(ptr, bytes, alignment);
+    }
+
+    std::pmr::memory_resource* m_upstream;
+};
+
+#endif // __has_include(<memory_resource>)
+#endif // C++17
@@ -0,0 +1,66 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * Allocation-free output to file descriptors, for reports that are written while the process heap must not be used
+ * (e.g. at exit) or that are too large for a reply buffer.
+ */
+namespace MemorySentinelOutput
+{
+/** Formats one line (at most 511 chars) and writes it to the file descriptor. Returns false if writing failed. */
+template<typename... Args>
+inline bool writeLine(int fileDescriptor, const char* format, Args... args) noexcept
+{
+    char line[512];
+    int length = snprintf(line, sizeof(line), format, args...);
+    length = length < static_cast<int>(sizeof(line)) ? length : static_cast<int>(sizeof(line)) - 1;
+#if defined(__unix__) || defined(__APPLE__)
+    const char* position = line;
+    while (length > 0) {
+        const ssize_t written = write(fileDescriptor, position, static_cast<std::size_t>(length));
+        if (written <= 0) {
+            return false;
+        }
+        position += written;
+        length -= static_cast<int>(written);
+    }
+    return true;
+#else
+    (void) fileDescriptor;
+    return false;
+#endif
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+/** Creates a pipe whose ends are not inherited by exec'd programs. Returns false on error. */
+inline bool openPipe(int fileDescriptors[2]) noexcept
+{
+#if defined(__APPLE__)
+    // no pipe2(): a concurrent fork/exec may still inherit the pipe before the flags are set
+    if (pipe(fileDescriptors) != 0) {
+        return false;
+    }
+    fcntl(fileDescriptors[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fileDescriptors[1], F_SETFD, FD_CLOEXEC);
+    return true;
+#else
+    return pipe2(fileDescriptors, O_CLOEXEC) == 0;
+#endif
+}
+#endif
+} // namespace MemorySentinelOutput
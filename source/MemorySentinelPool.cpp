@@ -0,0 +1,171 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include "MemorySentinelPool.hpp"
+#include "MemorySentinelArena.hpp"
+#include "MemorySentinelShards.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+using MemorySentinelShards::CACHE_LINE_SIZE;
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Layout
+// One mapping: the blocks of all size classes (bytesPerSizeClass each, so every block is aligned to its size), followed
+// by a link array per size class. Each size class keeps its free blocks in a lock-free stack of block indices; the head
+// packs a tag (incremented on every update, against ABA) with the top index + 1 (0 = empty). The links are kept apart
+// from the blocks, so a pop never reads memory that a concurrent owner of the block may be writing.
+struct alignas(CACHE_LINE_SIZE) PoolSizeClass
+{
+    std::atomic<std::uint64_t> freeList { 0 };
+    std::atomic<std::uint32_t>* links = nullptr; // index + 1 of the next free block (0 = none)
+    std::size_t numBlocks = 0;
+};
+
+static PoolSizeClass poolSizeClasses[MemorySentinelPool::NUM_SIZE_CLASSES];
+static std::atomic<char*> poolBlocks { nullptr };
+static std::size_t poolBytesPerSizeClass = 0; // written before poolBlocks is published
+static std::mutex poolMutex; // serializes initialization
+
+static std::atomic<std::uint64_t> poolAllocations { 0 };
+static std::atomic<std::uint64_t> poolDeallocations { 0 };
+static std::atomic<std::uint64_t> poolExhaustions { 0 };
+
+static constexpr std::uint64_t POOL_INDEX_MASK = 0xFFFFFFFFull;
+static constexpr std::size_t POOL_PAGE_SIZE = 4096;
+
+constexpr std::size_t MemorySentinelPool::NUM_SIZE_CLASSES;
+constexpr std::size_t MemorySentinelPool::MIN_BLOCK_SIZE;
+constexpr std::size_t MemorySentinelPool::MAX_BLOCK_SIZE;
+
+bool MemorySentinelPool::initialize(std::size_t bytesPerSizeClass) noexcept
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (poolBlocks.load() != nullptr) {
+        return true;
+    }
+    bytesPerSizeClass = (bytesPerSizeClass + MAX_BLOCK_SIZE - 1) / MAX_BLOCK_SIZE * MAX_BLOCK_SIZE;
+    if (bytesPerSizeClass == 0 || bytesPerSizeClass / MIN_BLOCK_SIZE > POOL_INDEX_MASK) {
+        return false;
+    }
+    std::size_t numLinks = 0;
+    for (std::size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        numLinks += bytesPerSizeClass / (MIN_BLOCK_SIZE << sizeClass);
+    }
+    const std::size_t blocksBytes = NUM_SIZE_CLASSES * bytesPerSizeClass;
+    char* memory = static_cast<char*>(MemorySentinelArena::map(blocksBytes + numLinks * sizeof(std::atomic<std::uint32_t>)));
+    if (memory == nullptr) {
+        return false;
+    }
+
+    // pre-fault the blocks, so the first use of a block does not page-fault
+    for (std::size_t offset = 0; offset < blocksBytes; offset += POOL_PAGE_SIZE) {
+        static_cast<volatile char*>(memory)[offset] = 0;
+    }
+    auto* links = reinterpret_cast<std::atomic<std::uint32_t>*>(memory + blocksBytes);
+    for (std::size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        PoolSizeClass& pool = poolSizeClasses[sizeClass];
+        pool.numBlocks = bytesPerSizeClass / (MIN_BLOCK_SIZE << sizeClass);
+        pool.links = links;
+        for (std::size_t index = 0; index < pool.numBlocks; ++index) {
+            pool.links[index].store(index + 1 < pool.numBlocks ? static_cast<std::uint32_t>(index + 2) : 0, std::memory_order_relaxed);
+        }
+        pool.freeList.store(1, std::memory_order_relaxed);
+        links += pool.numBlocks;
+    }
+    poolBytesPerSizeClass = bytesPerSizeClass;
+    poolBlocks.store(memory, std::memory_order_release);
+    return true;
+}
+
+static std::size_t poolSizeClassOf(std::size_t size) noexcept
+{
+    std::size_t sizeClass = 0;
+    while ((MemorySentinelPool::MIN_BLOCK_SIZE << sizeClass) < size) {
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+void* MemorySentinelPool::allocate(std::size_t size) noexcept
+{
+    char* blocks = poolBlocks.load(std::memory_order_acquire);
+    if (blocks == nullptr) {
+        return nullptr;
+    }
+    if (size > MAX_BLOCK_SIZE) {
+        poolExhaustions.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    const std::size_t sizeClass = poolSizeClassOf(size);
+    PoolSizeClass& pool = poolSizeClasses[sizeClass];
+    std::uint64_t head = pool.freeList.load(std::memory_order_acquire);
+    while (true) {
+        const std::uint64_t top = head & POOL_INDEX_MASK;
+        if (top == 0) {
+            poolExhaustions.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        const std::uint64_t next = pool.links[top - 1].load(std::memory_order_relaxed);
+        const std::uint64_t updated = (((head >> 32) + 1) << 32) | next;
+        if (pool.freeList.compare_exchange_weak(head, updated, std::memory_order_acquire, std::memory_order_acquire)) {
+            poolAllocations.fetch_add(1, std::memory_order_relaxed);
+            return blocks + sizeClass * poolBytesPerSizeClass + (top - 1) * (MIN_BLOCK_SIZE << sizeClass);
+        }
+    }
+}
+
+bool MemorySentinelPool::owns(const void* ptr) noexcept
+{
+    const char* blocks = poolBlocks.load(std::memory_order_acquire);
+    const char* block = static_cast<const char*>(ptr);
+    return blocks != nullptr && block >= blocks && block < blocks + NUM_SIZE_CLASSES * poolBytesPerSizeClass;
+}
+
+std::size_t MemorySentinelPool::blockSize(const void* ptr) noexcept
+{
+    const std::size_t offset = static_cast<std::size_t>(static_cast<const char*>(ptr) - poolBlocks.load(std::memory_order_acquire));
+    return MIN_BLOCK_SIZE << (offset / poolBytesPerSizeClass);
+}
+
+void MemorySentinelPool::deallocate(void* ptr) noexcept
+{
+    const std::size_t offset = static_cast<std::size_t>(static_cast<char*>(ptr) - poolBlocks.load(std::memory_order_acquire));
+    const std::size_t sizeClass = offset / poolBytesPerSizeClass;
+    PoolSizeClass& pool = poolSizeClasses[sizeClass];
+    const std::uint64_t index = (offset % poolBytesPerSizeClass) / (MIN_BLOCK_SIZE << sizeClass);
+    std::uint64_t head = pool.freeList.load(std::memory_order_relaxed);
+    std::uint64_t updated = 0;
+    do {
+        pool.links[index].store(static_cast<std::uint32_t>(head & POOL_INDEX_MASK), std::memory_order_relaxed);
+        updated = (((head >> 32) + 1) << 32) | (index + 1);
+    } while (!pool.freeList.compare_exchange_weak(head, updated, std::memory_order_release, std::memory_order_relaxed));
+    poolDeallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemorySentinelPool::prepareFork() noexcept
+{
+    poolMutex.lock();
+}
+
+void MemorySentinelPool::afterFork() noexcept
+{
+    poolMutex.unlock();
+}
+
+MemorySentinel::FallbackPoolStatistics MemorySentinelPool::read() noexcept
+{
+    MemorySentinel::FallbackPoolStatistics result;
+    result.allocations = poolAllocations.load(std::memory_order_relaxed);
+    result.exhaustions = poolExhaustions.load(std::memory_order_relaxed);
+    const std::uint64_t deallocations = poolDeallocations.load(std::memory_order_relaxed);
+    result.blocksInUse = result.allocations > deallocations ? result.allocations - deallocations : 0;
+    return result;
+}
@@ -0,0 +1,52 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include "MemorySentinel.hpp"
+
+#include <cstddef>
+
+/**
+ * Preallocated, lock-free size-class pool that serves quota-permitted allocations while armed, so budgeted allocations
+ * take a bounded number of atomic operations instead of a trip into the platform allocator (locks, page faults).
+ * The pool is mapped from the sentinel's private arena and pre-faulted when initialized; its blocks are recognized by
+ * address range. allocate() and deallocate() are allocation-free and wait-free apart from CAS retries.
+ */
+class MemorySentinelPool
+{
+public:
+    static constexpr std::size_t NUM_SIZE_CLASSES = 9;       ///< 16, 32, ..., 4096 bytes
+    static constexpr std::size_t MIN_BLOCK_SIZE = 16;
+    static constexpr std::size_t MAX_BLOCK_SIZE = MIN_BLOCK_SIZE << (NUM_SIZE_CLASSES - 1);
+
+    /**
+     * Maps and pre-faults the pool on first call (later calls keep the existing pool).
+     * @param bytesPerSizeClass capacity of each size class (rounded up to a multiple of MAX_BLOCK_SIZE)
+     * @return false if not supported on this platform or out of memory
+     */
+    static bool initialize(std::size_t bytesPerSizeClass) noexcept;
+
+    /** Returns a block of at least size bytes, or nullptr if the size is too large or its size class is exhausted */
+    static void* allocate(std::size_t size) noexcept;
+
+    /** True if ptr is a block of the pool */
+    static bool owns(const void* ptr) noexcept;
+
+    /** Block size of a block of the pool */
+    static std::size_t blockSize(const void* ptr) noexcept;
+
+    /** Returns a block of the pool (ptr must be owned by the pool) */
+    static void deallocate(void* ptr) noexcept;
+
+    static MemorySentinel::FallbackPoolStatistics read() noexcept;
+
+    /** Fork handlers (see MemorySentinel::installForkHandlers): no initialization is in progress while forking */
+    static void prepareFork() noexcept;
+    static void afterFork() noexcept;
+};
@@ -0,0 +1,292 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include "MemorySentinelSampler.hpp"
+#include "MemorySentinel.hpp"
+#include "MemorySentinelArena.hpp"
+#include "MemorySentinelOutput.hpp"
+
+#include <atomic>
+
+constexpr std::size_t MemorySentinelSampler::CAPACITY;
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Ring
+// Single writer (the sampler thread). Each slot carries a sequence number: 2 * index + 1 while the writer fills it with
+// sample #index, 2 * index + 2 once complete. A sample is published by incrementing sampleCount afterwards, so a reader
+// can copy samples [count - CAPACITY, count) and discard those whose slot the writer has reused in the meantime. The
+// fields are relaxed atomics, so such a copy is merely stale, never a data race.
+struct SampleSlot
+{
+    std::atomic<std::uint64_t> sequence;
+    std::atomic<std::uint64_t> fields[5]; // in the order of MemorySentinelSampler::Sample
+};
+
+static SampleSlot* sampleRing = nullptr; // mapped (zeroed) from the arena on first start
+static std::atomic<std::uint64_t> sampleCount { 0 };
+
+static void writeSample(std::uint64_t index, const MemorySentinelSampler::Sample& sample) noexcept
+{
+    SampleSlot& slot = sampleRing[index % MemorySentinelSampler::CAPACITY];
+    const std::uint64_t fields[5] = { sample.timeNs, sample.liveBytes, sample.liveBlocks, sample.allocations, sample.deallocations };
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < 5; ++i) {
+        slot.fields[i].store(fields[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    sampleCount.store(index + 1, std::memory_order_release);
+}
+
+/** Returns false if the slot no longer (or not yet) holds the complete sample #index */
+static bool copySample(std::uint64_t index, MemorySentinelSampler::Sample& sample) noexcept
+{
+    const SampleSlot& slot = sampleRing[index % MemorySentinelSampler::CAPACITY];
+    const std::uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    std::uint64_t fields[5];
+    for (std::size_t i = 0; i < 5; ++i) {
+        fields[i] = slot.fields[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence != 2 * index + 2 || slot.sequence.load(std::memory_order_relaxed) != sequence) {
+        return false;
+    }
+    sample.timeNs = fields[0];
+    sample.liveBytes = fields[1];
+    sample.liveBlocks = fields[2];
+    sample.allocations = fields[3];
+    sample.deallocations = fields[4];
+    return true;
+}
+
+static std::uint64_t firstSampleInRing(std::uint64_t count) noexcept
+{
+    return count > MemorySentinelSampler::CAPACITY ? count - MemorySentinelSampler::CAPACITY : 0;
+}
+
+std::size_t MemorySentinelSampler::getNumSamples() noexcept
+{
+    return static_cast<std::size_t>(sampleCount.load(std::memory_order_acquire));
+}
+
+std::size_t MemorySentinelSampler::readSamples(Sample* result, std::size_t maxCount) noexcept
+{
+    if (result == nullptr || sampleRing == nullptr) {
+        return 0;
+    }
+    const std::uint64_t count = sampleCount.load(std::memory_order_acquire);
+    std::uint64_t first = firstSampleInRing(count);
+    first = (count - first > maxCount) ? count - maxCount : first;
+    std::size_t written = 0;
+    for (std::uint64_t index = first; index < count; ++index) {
+        if (copySample(index, result[written])) {
+            ++written;
+        }
+    }
+    return written;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Export
+
+static double perSecond(std::uint64_t events, std::uint64_t intervalNs) noexcept
+{
+    return intervalNs > 0 ? static_cast<double>(events) * 1e9 / static_cast<double>(intervalNs) : 0.0;
+}
+
+/** Calls writeRow(sample, allocationsPerSecond, deallocationsPerSecond, isFirst) for each sample in the ring */
+template<class RowWriter>
+static bool writeRows(RowWriter writeRow) noexcept
+{
+    if (sampleRing == nullptr) {
+        return true;
+    }
+    const std::uint64_t count = sampleCount.load(std::memory_order_acquire);
+    std::uint64_t previousTimeNs = 0;
+    bool isFirst = true;
+    for (std::uint64_t index = firstSampleInRing(count); index < count; ++index) {
+        MemorySentinelSampler::Sample sample;
+        if (!copySample(index, sample)) {
+            continue;
+        }
+        const std::uint64_t intervalNs = sample.timeNs - previousTimeNs;
+        if (!writeRow(sample, perSecond(sample.allocations, intervalNs), perSecond(sample.deallocations, intervalNs), isFirst)) {
+            return false;
+        }
+        previousTimeNs = sample.timeNs;
+        isFirst = false;
+    }
+    return true;
+}
+
+bool MemorySentinelSampler::writeCsv(int fileDescriptor) noexcept
+{
+    using MemorySentinelOutput::writeLine;
+    if (!writeLine(fileDescriptor, "time_ms,live_bytes,live_blocks,allocations_per_s,deallocations_per_s\n")) {
+        return false;
+    }
+    return writeRows([fileDescriptor](const Sample& sample, double allocationRate, double deallocationRate, bool) {
+        return writeLine(fileDescriptor, "%.3f,%llu,%llu,%.1f,%.1f\n", static_cast<double>(sample.timeNs) / 1e6,
+                         static_cast<unsigned long long>(sample.liveBytes),
+                         static_cast<unsigned long long>(sample.liveBlocks), allocationRate, deallocationRate);
+    });
+}
+
+bool MemorySentinelSampler::writeJson(int fileDescriptor) noexcept
+{
+    using MemorySentinelOutput::writeLine;
+    if (!writeLine(fileDescriptor, "[")) {
+        return false;
+    }
+    const bool success = writeRows([fileDescriptor](const Sample& sample, double allocationRate, double deallocationRate, bool isFirst) {
+        return writeLine(fileDescriptor, "%s\n  {\"time_ms\": %.3f, \"live_bytes\": %llu, \"live_blocks\": %llu, "
+                         "\"allocations_per_s\": %.1f, \"deallocations_per_s\": %.1f}",
+                         isFirst ? "" : ",", static_cast<double>(sample.timeNs) / 1e6,
+                         static_cast<unsigned long long>(sample.liveBytes),
+                         static_cast<unsigned long long>(sample.liveBlocks), allocationRate, deallocationRate);
+    });
+    return success && writeLine(fileDescriptor, "\n]\n");
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Sampler thread (POSIX only)
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cerrno>
+#include <ctime>
+#include <mutex>
+
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+
+static std::mutex samplerLifecycleMutex;
+static std::atomic<bool> isSampling { false };
+static pthread_t samplerThread;
+static int samplerWakePipe[2] = { -1, -1 };
+static int samplingIntervalMs = 10;
+
+static std::uint64_t monotonicNs() noexcept
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<std::uint64_t>(now.tv_sec) * 1000000000ull + static_cast<std::uint64_t>(now.tv_nsec);
+}
+
+static void* samplerThreadMain(void*)
+{
+    const std::uint64_t startNs = monotonicNs();
+    MemorySentinel::Statistics previous = MemorySentinel::getStatistics();
+    std::uint64_t nextNs = startNs;
+    while (true) {
+        // fixed rate: the deadline advances by the interval, regardless of how long sampling took
+        nextNs += static_cast<std::uint64_t>(samplingIntervalMs) * 1000000ull;
+        const std::uint64_t nowNs = monotonicNs();
+        const int timeoutMs = nextNs > nowNs ? static_cast<int>((nextNs - nowNs + 999999) / 1000000) : 0;
+        pollfd wake { samplerWakePipe[0], POLLIN, 0 };
+        const int ready = poll(&wake, 1, timeoutMs);
+        if (ready > 0) {
+            break; // stop requested
+        }
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        
+        const MemorySentinel::Statistics current = MemorySentinel::getStatistics();
+        // the counters only count every n-th event: scale the differences back up to estimate all events
+        const auto samplingInterval = static_cast<std::uint64_t>(MemorySentinel::getSamplingInterval());
+        MemorySentinelSampler::Sample sample;
+        sample.timeNs = monotonicNs() - startNs;
+        sample.liveBytes = current.liveBytes;
+        sample.liveBlocks = current.liveBlocks;
+        sample.allocations = current.allocations >= previous.allocations ? current.allocations - previous.allocations : 0;
+        sample.allocations *= samplingInterval;
+        sample.deallocations = current.deallocations >= previous.deallocations ? current.deallocations - previous.deallocations : 0;
+        sample.deallocations *= samplingInterval;
+        writeSample(sampleCount.load(std::memory_order_relaxed), sample);
+        previous = current;
+    }
+    return nullptr;
+}
+
+bool MemorySentinelSampler::start(int intervalMs) noexcept
+{
+    std::lock_guard<std::mutex> lock(samplerLifecycleMutex);
+    if (isSampling.load() || intervalMs <= 0) {
+        return false;
+    }
+    if (sampleRing == nullptr) {
+        sampleRing = static_cast<SampleSlot*>(MemorySentinelArena::map(CAPACITY * sizeof(SampleSlot)));
+        if (sampleRing == nullptr) {
+            return false;
+        }
+    }
+    if (!MemorySentinelOutput::openPipe(samplerWakePipe)) {
+        return false;
+    }
+    samplingIntervalMs = intervalMs;
+    sampleCount.store(0);
+    if (pthread_create(&samplerThread, nullptr, samplerThreadMain, nullptr) != 0) {
+        close(samplerWakePipe[0]);
+        close(samplerWakePipe[1]);
+        return false;
+    }
+    isSampling.store(true);
+    return true;
+}
+
+void MemorySentinelSampler::stop() noexcept
+{
+    std::lock_guard<std::mutex> lock(samplerLifecycleMutex);
+    if (!isSampling.load()) {
+        return;
+    }
+    const char wake = 1;
+    (void) !write(samplerWakePipe[1], &wake, 1);
+    pthread_join(samplerThread, nullptr);
+    close(samplerWakePipe[0]);
+    close(samplerWakePipe[1]);
+    isSampling.store(false);
+}
+
+bool MemorySentinelSampler::isRunning() noexcept
+{
+    return isSampling.load();
+}
+
+void MemorySentinelSampler::prepareFork() noexcept
+{
+    samplerLifecycleMutex.lock();
+}
+
+void MemorySentinelSampler::parentAfterFork() noexcept
+{
+    samplerLifecycleMutex.unlock();
+}
+
+void MemorySentinelSampler::childAfterFork() noexcept
+{
+    if (isSampling.load()) {
+        close(samplerWakePipe[0]);
+        close(samplerWakePipe[1]);
+        sampleCount.store(0);
+        isSampling.store(false);
+    }
+    samplerLifecycleMutex.unlock();
+}
+
+#else // POSIX
+
+bool MemorySentinelSampler::start(int) noexcept { return false; }
+void MemorySentinelSampler::stop() noexcept {}
+bool MemorySentinelSampler::isRunning() noexcept { return false; }
+void MemorySentinelSampler::prepareFork() noexcept {}
+void MemorySentinelSampler::parentAfterFork() noexcept {}
+void MemorySentinelSampler::childAfterFork() noexcept {}
+
+#endif // POSIX
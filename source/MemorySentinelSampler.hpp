@@ -0,0 +1,56 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Opt-in heap growth timeline: a background thread samples the sentinel's statistics counters at a fixed interval
+ * into a preallocated ring (in the sentinel's private arena), which can be exported as CSV or JSON. There is no
+ * per-event cost beyond the statistics themselves, which must be enabled (MemorySentinel::setStatisticsEnabled).
+ * POSIX only. The sampler thread does not allocate while running.
+ */
+class MemorySentinelSampler
+{
+public:
+    struct Sample
+    {
+        std::uint64_t timeNs = 0;        ///< since the sampler was started
+        std::uint64_t liveBytes = 0;     ///< as in MemorySentinel::Statistics (from the sampled events, not scaled)
+        std::uint64_t liveBlocks = 0;
+        std::uint64_t allocations = 0;   ///< since the previous sample (the sampled count, times the sampling interval)
+        std::uint64_t deallocations = 0; ///< since the previous sample (the sampled count, times the sampling interval)
+    };
+
+    static constexpr std::size_t CAPACITY = 16384; ///< most recent samples kept in the ring
+
+    /** Clears the ring and starts sampling every intervalMs. Returns false if already running or not supported. */
+    static bool start(int intervalMs = 10) noexcept;
+    static void stop() noexcept;
+    static bool isRunning() noexcept;
+
+    /** Fork handlers (see MemorySentinel::installForkHandlers): the child has no sampler thread, it is reset to stopped */
+    static void prepareFork() noexcept;
+    static void parentAfterFork() noexcept;
+    static void childAfterFork() noexcept;
+
+    /** Number of samples recorded since the last start (the ring keeps the most recent CAPACITY of them) */
+    static std::size_t getNumSamples() noexcept;
+
+    /**
+     * Copies the most recent samples (oldest first) into result.
+     * @return the number of samples written
+     */
+    static std::size_t readSamples(Sample* result, std::size_t maxCount) noexcept;
+
+    /** Write the samples in the ring, with rates in events per second, to a file descriptor */
+    static bool writeCsv(int fileDescriptor) noexcept;
+    static bool writeJson(int fileDescriptor) noexcept;
+};
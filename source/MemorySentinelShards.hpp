@@ -0,0 +1,33 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Helpers to spread frequently written state over cache-line-padded shards, so that threads allocating concurrently
+ * don't contend on a single cache line. Each thread is assigned a shard (round-robin) on first use.
+ */
+namespace MemorySentinelShards
+{
+static constexpr std::size_t CACHE_LINE_SIZE = 64;
+static constexpr std::size_t NUM_SHARDS = 64; // must be a power of two
+
+/** Returns the shard index of the calling thread (allocation-free, cheap after the first call) */
+inline std::size_t currentShardIndex() noexcept
+{
+    static std::atomic<std::size_t> nextShardIndex { 0 };
+    static thread_local std::size_t shardIndex = NUM_SHARDS; // NUM_SHARDS = not assigned yet
+    if (shardIndex == NUM_SHARDS) {
+        shardIndex = nextShardIndex.fetch_add(1, std::memory_order_relaxed) & (NUM_SHARDS - 1);
+    }
+    return shardIndex;
+}
+} // namespace MemorySentinelShards
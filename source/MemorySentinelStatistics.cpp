@@ -0,0 +1,704 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include "MemorySentinelStatistics.hpp"
+#include "MemorySentinelShards.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__clang__) || defined(__GNUC__)
+    #include <dlfcn.h>
+#endif
+
+using MemorySentinelShards::CACHE_LINE_SIZE;
+using MemorySentinelShards::NUM_SHARDS;
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Counters
+// Each thread only writes to its own cache-line-padded shard; the shards are summed up when the statistics are read.
+struct alignas(CACHE_LINE_SIZE) CounterShard
+{
+    std::atomic<std::uint64_t> allocations { 0 };
+    std::atomic<std::uint64_t> deallocations { 0 };
+    std::atomic<std::uint64_t> allocatedBytes { 0 };
+    std::atomic<std::uint64_t> permittedAllocations { 0 };
+    std::atomic<std::uint64_t> exemptAllocations { 0 };
+    std::atomic<std::uint64_t> transgressions { 0 };
+    std::atomic<std::uint64_t> usableBytesAllocated { 0 };
+    std::atomic<std::uint64_t> usableBytesFreed { 0 };
+};
+
+static CounterShard counterShards[NUM_SHARDS];
+
+static CounterShard& currentCounterShard() noexcept
+{
+    return counterShards[MemorySentinelShards::currentShardIndex()];
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Size histogram
+// Requested sizes in classes of a power of two with 4 sub-buckets each (10, 12, 14, 16, 20, 24, ...), sizes 1..8 in
+// classes of their own. Sharded like the counters and merged when read.
+static constexpr unsigned SIZE_SUB_BUCKET_BITS = 2;
+static constexpr std::size_t NUM_SIZE_SUB_BUCKETS = 1 << SIZE_SUB_BUCKET_BITS;
+
+struct alignas(CACHE_LINE_SIZE) SizeHistogramShard
+{
+    std::atomic<std::uint64_t> classes[MemorySentinel::NUM_SIZE_CLASSES];
+};
+
+static SizeHistogramShard sizeHistogramShards[NUM_SHARDS];
+
+static unsigned floorLog2(std::uint64_t value) noexcept
+{
+    unsigned exponent = 0;
+    while ((value >>= 1) != 0) {
+        ++exponent;
+    }
+    return exponent;
+}
+
+/** Class of a requested size: the class with the smallest maximum size >= size */
+static std::size_t sizeClassIndex(std::size_t size) noexcept
+{
+    const std::uint64_t value = size > 0 ? static_cast<std::uint64_t>(size) - 1 : 0;
+    if (value < 2 * NUM_SIZE_SUB_BUCKETS) {
+        return static_cast<std::size_t>(value);
+    }
+    const unsigned exponent = floorLog2(value);
+    const std::size_t subBucket = static_cast<std::size_t>(value >> (exponent - SIZE_SUB_BUCKET_BITS)) & (NUM_SIZE_SUB_BUCKETS - 1);
+    return 2 * NUM_SIZE_SUB_BUCKETS + (exponent - SIZE_SUB_BUCKET_BITS - 1) * NUM_SIZE_SUB_BUCKETS + subBucket;
+}
+
+/** Largest size in a class (inverse of sizeClassIndex); the last class is open-ended */
+static std::uint64_t sizeClassMaxSize(std::size_t index) noexcept
+{
+    if (index < 2 * NUM_SIZE_SUB_BUCKETS) {
+        return index + 1;
+    }
+    if (index == MemorySentinel::NUM_SIZE_CLASSES - 1) {
+        return UINT64_MAX; // 2^64 does not fit
+    }
+    const std::size_t exponent = (index - 2 * NUM_SIZE_SUB_BUCKETS) / NUM_SIZE_SUB_BUCKETS + SIZE_SUB_BUCKET_BITS + 1;
+    const std::size_t subBucket = (index - 2 * NUM_SIZE_SUB_BUCKETS) % NUM_SIZE_SUB_BUCKETS;
+    return static_cast<std::uint64_t>(NUM_SIZE_SUB_BUCKETS + subBucket + 1) << (exponent - SIZE_SUB_BUCKET_BITS);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Call-site table
+// Fixed-size open-addressing table keyed by return address. Entries are claimed with a CAS and never released
+// (reset only clears the counters), so lookups never race with removals. Call sites that don't find a free entry
+// within MAX_PROBES are accounted in overflowCallSite. The counters of each entry are striped over a few cache lines,
+// so a single hot call site shared by many threads does not serialize them.
+static constexpr std::size_t NUM_CALL_SITE_STRIPES = 8; // must be a power of two
+
+struct alignas(CACHE_LINE_SIZE) CallSiteStripe
+{
+    std::atomic<std::uint64_t> allocations { 0 };
+    std::atomic<std::uint64_t> allocatedBytes { 0 };
+    std::atomic<std::uint64_t> growingReallocations { 0 };
+    std::atomic<std::uint64_t> smallStepGrowths { 0 };
+    std::atomic<std::uint64_t> copiedBytes { 0 };
+};
+
+struct CallSiteEntry
+{
+    std::atomic<std::uintptr_t> address { 0 };
+    std::atomic<std::uint64_t> longestReallocChain { 0 };
+    CallSiteStripe stripes[NUM_CALL_SITE_STRIPES];
+
+    std::uint64_t sum(std::atomic<std::uint64_t> CallSiteStripe::* counter) const noexcept
+    {
+        std::uint64_t total = 0;
+        for (const CallSiteStripe& stripe : stripes) {
+            total += (stripe.*counter).load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+static constexpr std::size_t NUM_CALL_SITES = 1024; // must be a power of two
+static constexpr std::size_t MAX_PROBES = 32;
+static CallSiteEntry callSites[NUM_CALL_SITES];
+static CallSiteEntry overflowCallSite;
+
+static CallSiteEntry& findCallSite(const void* callSite) noexcept
+{
+    const auto address = reinterpret_cast<std::uintptr_t>(callSite);
+    if (address == 0) {
+        return overflowCallSite;
+    }
+    std::size_t index = static_cast<std::size_t>((static_cast<std::uint64_t>(address) * 0x9E3779B97F4A7C15ull) >> 32);
+    for (std::size_t probe = 0; probe < MAX_PROBES; ++probe) {
+        CallSiteEntry& entry = callSites[(index + probe) & (NUM_CALL_SITES - 1)];
+        std::uintptr_t current = entry.address.load(std::memory_order_acquire);
+        if (current == address) {
+            return entry;
+        }
+        if (current == 0) {
+            if (entry.address.compare_exchange_strong(current, address, std::memory_order_acq_rel) || current == address) {
+                return entry;
+            }
+        }
+    }
+    return overflowCallSite;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Tag table
+// Fixed-size open-addressing table of scope tags, hashed by string content and keyed by the first pointer registered
+// for that content. Like call sites, entries are claimed with a CAS and never released. Scopes intern their tag once
+// when they are entered, so the hooks only index the table.
+struct alignas(CACHE_LINE_SIZE) TagStripe
+{
+    std::atomic<std::uint64_t> allocations { 0 };
+    std::atomic<std::uint64_t> allocatedBytes { 0 };
+    std::atomic<std::uint64_t> transgressions { 0 };
+};
+
+struct TagEntry
+{
+    std::atomic<const char*> name { nullptr };
+    TagStripe stripes[NUM_CALL_SITE_STRIPES];
+
+    std::uint64_t sum(std::atomic<std::uint64_t> TagStripe::* counter) const noexcept
+    {
+        std::uint64_t total = 0;
+        for (const TagStripe& stripe : stripes) {
+            total += (stripe.*counter).load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+static constexpr std::size_t NUM_TAGS = 256; // must be a power of two
+static TagEntry tags[NUM_TAGS];
+
+static std::size_t hashTag(const char* tag) noexcept
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull; // FNV-1a
+    for (const char* c = tag; *c != '\0'; ++c) {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 0x100000001b3ull;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+/** Slot of tag, claiming a new one if isClaiming (-1: not found or table full) */
+static int findTag(const char* tag, bool isClaiming) noexcept
+{
+    const std::size_t index = hashTag(tag);
+    for (std::size_t probe = 0; probe < NUM_TAGS; ++probe) {
+        const std::size_t slot = (index + probe) & (NUM_TAGS - 1);
+        TagEntry& entry = tags[slot];
+        const char* current = entry.name.load(std::memory_order_acquire);
+        if (current == nullptr) {
+            if (!isClaiming) {
+                return -1;
+            }
+            if (entry.name.compare_exchange_strong(current, tag, std::memory_order_acq_rel)) {
+                return static_cast<int>(slot);
+            }
+        }
+        if (current == tag || strcmp(current, tag) == 0) {
+            return static_cast<int>(slot);
+        }
+    }
+    return -1;
+}
+
+int MemorySentinelStatistics::internTag(const char* tag) noexcept
+{
+    return tag != nullptr ? findTag(tag, true) : -1;
+}
+
+// Composed tags are copied into this pool when first interned (like the table, it is never released)
+static constexpr std::size_t TAG_NAME_POOL_SIZE = 16 * 1024;
+static constexpr std::size_t MAX_COMPOSED_TAG_LENGTH = 256;
+static char tagNamePool[TAG_NAME_POOL_SIZE];
+static std::atomic<std::size_t> tagNamePoolUsed { 0 };
+
+int MemorySentinelStatistics::internTag(const char* label, const char* qualifier) noexcept
+{
+    if (label == nullptr || qualifier == nullptr) {
+        return internTag(label != nullptr ? label : qualifier);
+    }
+    char composed[MAX_COMPOSED_TAG_LENGTH];
+    const int length = snprintf(composed, sizeof(composed), "%s [%s]", label, qualifier);
+    if (length < 0) {
+        return -1;
+    }
+    const int existing = findTag(composed, false);
+    if (existing >= 0) {
+        return existing;
+    }
+    const std::size_t size = strlen(composed) + 1;
+    const std::size_t offset = tagNamePoolUsed.fetch_add(size, std::memory_order_relaxed);
+    if (offset + size > TAG_NAME_POOL_SIZE) {
+        return -1;
+    }
+    memcpy(tagNamePool + offset, composed, size);
+    return findTag(tagNamePool + offset, true);
+}
+
+static TagStripe& currentTagStripe(int tagIndex) noexcept
+{
+    return tags[tagIndex].stripes[MemorySentinelShards::currentShardIndex() & (NUM_CALL_SITE_STRIPES - 1)];
+}
+
+void MemorySentinelStatistics::recordTagAllocation(int tagIndex, std::size_t size) noexcept
+{
+    TagStripe& stripe = currentTagStripe(tagIndex);
+    stripe.allocations.fetch_add(1, std::memory_order_relaxed);
+    stripe.allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void MemorySentinelStatistics::recordTagTransgression(int tagIndex) noexcept
+{
+    currentTagStripe(tagIndex).transgressions.fetch_add(1, std::memory_order_relaxed);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Recording
+
+void MemorySentinelStatistics::recordAllocation(std::size_t size, std::size_t usableSize, const void* callSite) noexcept
+{
+    CounterShard& shard = currentCounterShard();
+    shard.allocations.fetch_add(1, std::memory_order_relaxed);
+    shard.allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    shard.usableBytesAllocated.fetch_add(usableSize, std::memory_order_relaxed);
+    sizeHistogramShards[MemorySentinelShards::currentShardIndex()].classes[sizeClassIndex(size)].fetch_add(1, std::memory_order_relaxed);
+
+    CallSiteStripe& stripe = findCallSite(callSite).stripes[MemorySentinelShards::currentShardIndex() & (NUM_CALL_SITE_STRIPES - 1)];
+    stripe.allocations.fetch_add(1, std::memory_order_relaxed);
+    stripe.allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+// The last block reallocated on this thread: consecutive reallocs of the same block from the same call site form a chain
+static thread_local const void* lastReallocatedBlock = nullptr;
+static thread_local const void* lastReallocCallSite = nullptr;
+static thread_local std::uint64_t reallocChainLength = 0;
+
+void MemorySentinelStatistics::recordReallocation(const void* oldPtr, std::size_t oldSize, const void* newPtr,
+                                                  std::size_t newSize, const void* callSite) noexcept
+{
+    if (oldPtr != lastReallocatedBlock || callSite != lastReallocCallSite) {
+        reallocChainLength = 0;
+    }
+    lastReallocatedBlock = newPtr;
+    lastReallocCallSite = callSite;
+    const std::uint64_t chainLength = ++reallocChainLength;
+    if (newSize <= oldSize) {
+        return; // shrinking is cheap
+    }
+    CallSiteEntry& entry = findCallSite(callSite);
+    CallSiteStripe& stripe = entry.stripes[MemorySentinelShards::currentShardIndex() & (NUM_CALL_SITE_STRIPES - 1)];
+    stripe.growingReallocations.fetch_add(1, std::memory_order_relaxed);
+    stripe.copiedBytes.fetch_add(oldSize, std::memory_order_relaxed); // upper bound: realloc may grow in place
+    if (newSize - oldSize < oldSize / 2) {
+        stripe.smallStepGrowths.fetch_add(1, std::memory_order_relaxed); // growth factor < 1.5: quadratic copying
+    }
+    std::uint64_t longest = entry.longestReallocChain.load(std::memory_order_relaxed);
+    while (longest < chainLength
+           && !entry.longestReallocChain.compare_exchange_weak(longest, chainLength, std::memory_order_relaxed)) {}
+}
+
+void MemorySentinelStatistics::recordDeallocation(std::size_t usableSize) noexcept
+{
+    CounterShard& shard = currentCounterShard();
+    shard.deallocations.fetch_add(1, std::memory_order_relaxed);
+    shard.usableBytesFreed.fetch_add(usableSize, std::memory_order_relaxed);
+}
+
+void MemorySentinelStatistics::recordPermittedAllocation() noexcept
+{
+    currentCounterShard().permittedAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemorySentinelStatistics::recordExemptAllocation() noexcept
+{
+    currentCounterShard().exemptAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemorySentinelStatistics::recordTransgression() noexcept
+{
+    currentCounterShard().transgressions.fetch_add(1, std::memory_order_relaxed);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Reading
+
+static std::uint64_t clampedDifference(std::uint64_t a, std::uint64_t b) noexcept
+{
+    return a > b ? a - b : 0; // counters are read independently, and frees of unsampled blocks may be recorded
+}
+
+MemorySentinel::Statistics MemorySentinelStatistics::read() noexcept
+{
+    MemorySentinel::Statistics result;
+    std::uint64_t usableBytesAllocated = 0;
+    std::uint64_t usableBytesFreed = 0;
+    for (const CounterShard& shard : counterShards) {
+        result.allocations += shard.allocations.load(std::memory_order_relaxed);
+        result.deallocations += shard.deallocations.load(std::memory_order_relaxed);
+        result.allocatedBytes += shard.allocatedBytes.load(std::memory_order_relaxed);
+        result.permittedAllocations += shard.permittedAllocations.load(std::memory_order_relaxed);
+        result.exemptAllocations += shard.exemptAllocations.load(std::memory_order_relaxed);
+        result.transgressions += shard.transgressions.load(std::memory_order_relaxed);
+        usableBytesAllocated += shard.usableBytesAllocated.load(std::memory_order_relaxed);
+        usableBytesFreed += shard.usableBytesFreed.load(std::memory_order_relaxed);
+    }
+    result.liveBlocks = clampedDifference(result.allocations, result.deallocations);
+    result.liveBytes = clampedDifference(usableBytesAllocated, usableBytesFreed);
+    return result;
+}
+
+std::size_t MemorySentinelStatistics::readTopCallSites(MemorySentinel::CallSite* result, std::size_t maxCount) noexcept
+{
+    if (result == nullptr) {
+        return 0;
+    }
+    // insertion into a sorted top-N list
+    std::size_t count = 0;
+    for (const CallSiteEntry& entry : callSites) {
+        MemorySentinel::CallSite candidate;
+        candidate.address = reinterpret_cast<const void*>(entry.address.load(std::memory_order_acquire));
+        candidate.allocations = entry.sum(&CallSiteStripe::allocations);
+        candidate.allocatedBytes = entry.sum(&CallSiteStripe::allocatedBytes);
+        if (candidate.address == nullptr || candidate.allocations == 0) {
+            continue;
+        }
+        std::size_t position = count;
+        while (position > 0 && result[position-1].allocatedBytes < candidate.allocatedBytes) {
+            if (position < maxCount) {
+                result[position] = result[position-1];
+            }
+            --position;
+        }
+        if (position < maxCount) {
+            result[position] = candidate;
+            count = count < maxCount ? count + 1 : maxCount;
+        }
+    }
+    return count;
+}
+
+static bool isMoreOffending(const MemorySentinel::Tag& a, const MemorySentinel::Tag& b) noexcept
+{
+    return a.transgressions != b.transgressions ? a.transgressions > b.transgressions : a.allocatedBytes > b.allocatedBytes;
+}
+
+std::size_t MemorySentinelStatistics::readTopTags(MemorySentinel::Tag* result, std::size_t maxCount) noexcept
+{
+    if (result == nullptr) {
+        return 0;
+    }
+    // insertion into a sorted top-N list
+    std::size_t count = 0;
+    for (const TagEntry& entry : tags) {
+        MemorySentinel::Tag candidate;
+        candidate.name = entry.name.load(std::memory_order_acquire);
+        candidate.allocations = entry.sum(&TagStripe::allocations);
+        candidate.allocatedBytes = entry.sum(&TagStripe::allocatedBytes);
+        candidate.transgressions = entry.sum(&TagStripe::transgressions);
+        if (candidate.name == nullptr || (candidate.allocations == 0 && candidate.transgressions == 0)) {
+            continue;
+        }
+        std::size_t position = count;
+        while (position > 0 && isMoreOffending(candidate, result[position-1])) {
+            if (position < maxCount) {
+                result[position] = result[position-1];
+            }
+            --position;
+        }
+        if (position < maxCount) {
+            result[position] = candidate;
+            count = count < maxCount ? count + 1 : maxCount;
+        }
+    }
+    return count;
+}
+
+std::size_t MemorySentinelStatistics::readSizeHistogram(MemorySentinel::SizeClass* result, std::size_t maxCount) noexcept
+{
+    std::size_t count = 0;
+    for (std::size_t index = 0; index < MemorySentinel::NUM_SIZE_CLASSES && count < maxCount && result != nullptr; ++index) {
+        std::uint64_t allocations = 0;
+        for (const SizeHistogramShard& shard : sizeHistogramShards) {
+            allocations += shard.classes[index].load(std::memory_order_relaxed);
+        }
+        if (allocations > 0) {
+            result[count].maxSize = sizeClassMaxSize(index);
+            result[count].allocations = allocations;
+            ++count;
+        }
+    }
+    return count;
+}
+
+std::size_t MemorySentinelStatistics::suggestSizeClasses(MemorySentinel::SizeClass* result, std::size_t maxCount, double coverage) noexcept
+{
+    MemorySentinel::SizeClass histogram[MemorySentinel::NUM_SIZE_CLASSES];
+    const std::size_t numClasses = readSizeHistogram(histogram, MemorySentinel::NUM_SIZE_CLASSES);
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < numClasses; ++i) {
+        total += histogram[i].allocations;
+    }
+    if (result == nullptr || total == 0) {
+        return 0;
+    }
+    // greedy: the most frequent classes until they cover the requested share of all allocations
+    std::sort(histogram, histogram + numClasses, [](const MemorySentinel::SizeClass& a, const MemorySentinel::SizeClass& b) {
+        return a.allocations > b.allocations;
+    });
+    std::size_t count = 0;
+    std::uint64_t covered = 0;
+    while (count < numClasses && count < maxCount && static_cast<double>(covered) < coverage * static_cast<double>(total)) {
+        covered += histogram[count].allocations;
+        result[count] = histogram[count];
+        ++count;
+    }
+    std::sort(result, result + count, [](const MemorySentinel::SizeClass& a, const MemorySentinel::SizeClass& b) {
+        return a.maxSize < b.maxSize;
+    });
+    return count;
+}
+
+std::size_t MemorySentinelStatistics::readTopReallocSites(MemorySentinel::ReallocSite* result, std::size_t maxCount) noexcept
+{
+    if (result == nullptr || maxCount == 0) {
+        return 0;
+    }
+    auto isWorse = [](const MemorySentinel::ReallocSite& a, const MemorySentinel::ReallocSite& b) {
+        return a.smallStepGrowths != b.smallStepGrowths ? a.smallStepGrowths > b.smallStepGrowths : a.copiedBytes > b.copiedBytes;
+    };
+    std::size_t count = 0;
+    for (const CallSiteEntry& entry : callSites) {
+        MemorySentinel::ReallocSite candidate;
+        candidate.address = reinterpret_cast<const void*>(entry.address.load(std::memory_order_acquire));
+        candidate.growingReallocations = entry.sum(&CallSiteStripe::growingReallocations);
+        candidate.smallStepGrowths = entry.sum(&CallSiteStripe::smallStepGrowths);
+        candidate.copiedBytes = entry.sum(&CallSiteStripe::copiedBytes);
+        candidate.longestChain = entry.longestReallocChain.load(std::memory_order_relaxed);
+        if (candidate.address == nullptr || candidate.growingReallocations == 0) {
+            continue;
+        }
+        std::size_t position = count;
+        while (position > 0 && isWorse(candidate, result[position-1])) {
+            if (position < maxCount) {
+                result[position] = result[position-1];
+            }
+            --position;
+        }
+        if (position < maxCount) {
+            result[position] = candidate;
+            count = count < maxCount ? count + 1 : count;
+        }
+    }
+    return count;
+}
+
+static void resetCallSite(CallSiteEntry& entry) noexcept
+{
+    for (CallSiteStripe& stripe : entry.stripes) {
+        stripe.allocations.store(0, std::memory_order_relaxed);
+        stripe.allocatedBytes.store(0, std::memory_order_relaxed);
+        stripe.growingReallocations.store(0, std::memory_order_relaxed);
+        stripe.smallStepGrowths.store(0, std::memory_order_relaxed);
+        stripe.copiedBytes.store(0, std::memory_order_relaxed);
+    }
+    entry.longestReallocChain.store(0, std::memory_order_relaxed);
+}
+
+void MemorySentinelStatistics::reset() noexcept
+{
+    for (CounterShard& shard : counterShards) {
+        shard.allocations.store(0, std::memory_order_relaxed);
+        shard.deallocations.store(0, std::memory_order_relaxed);
+        shard.allocatedBytes.store(0, std::memory_order_relaxed);
+        shard.permittedAllocations.store(0, std::memory_order_relaxed);
+        shard.exemptAllocations.store(0, std::memory_order_relaxed);
+        shard.transgressions.store(0, std::memory_order_relaxed);
+        shard.usableBytesAllocated.store(0, std::memory_order_relaxed);
+        shard.usableBytesFreed.store(0, std::memory_order_relaxed);
+    }
+    for (CallSiteEntry& entry : callSites) {
+        resetCallSite(entry);
+    }
+    resetCallSite(overflowCallSite);
+    for (SizeHistogramShard& shard : sizeHistogramShards) {
+        for (auto& sizeClass : shard.classes) {
+            sizeClass.store(0, std::memory_order_relaxed);
+        }
+    }
+    for (TagEntry& entry : tags) {
+        for (TagStripe& stripe : entry.stripes) {
+            stripe.allocations.store(0, std::memory_order_relaxed);
+            stripe.allocatedBytes.store(0, std::memory_order_relaxed);
+            stripe.transgressions.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// MARK: - Formatting
+
+/** snprintf that appends at position and never runs past the end of the buffer */
+template<typename... Args>
+static void appendFormatted(char* buffer, std::size_t bufferSize, std::size_t& position, const char* format, Args... args) noexcept
+{
+    if (position + 1 >= bufferSize) {
+        return;
+    }
+    int written = snprintf(buffer + position, bufferSize - position, format, args...);
+    if (written > 0) {
+        position += static_cast<std::size_t>(written);
+        position = position < bufferSize ? position : bufferSize - 1;
+    }
+}
+
+std::size_t MemorySentinelStatistics::format(char* buffer, std::size_t bufferSize) noexcept
+{
+    if (buffer == nullptr || bufferSize == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+    const auto stats = read();
+    const auto config = MemorySentinel::getConfig();
+    std::size_t position = 0;
+    appendFormatted(buffer, bufferSize, position,
+                    "allocations: %llu\n"
+                    "deallocations: %llu\n"
+                    "allocated bytes: %llu\n"
+                    "permitted allocations: %llu\n"
+                    "exempt allocations: %llu\n"
+                    "transgressions: %llu\n"
+                    "sampling interval: %d\n",
+                    static_cast<unsigned long long>(stats.allocations),
+                    static_cast<unsigned long long>(stats.deallocations),
+                    static_cast<unsigned long long>(stats.allocatedBytes),
+                    static_cast<unsigned long long>(stats.permittedAllocations),
+                    static_cast<unsigned long long>(stats.exemptAllocations),
+                    static_cast<unsigned long long>(stats.transgressions),
+                    config.samplingInterval);
+    return position;
+}
+
+std::size_t MemorySentinelStatistics::formatHeapProfile(char* buffer, std::size_t bufferSize, std::size_t numCallSites) noexcept
+{
+    std::size_t position = format(buffer, bufferSize);
+    if (position == 0) {
+        return 0;
+    }
+    const auto stats = read();
+    appendFormatted(buffer, bufferSize, position, "live blocks: %llu\nlive bytes: %llu\ntop call sites (by bytes):\n",
+                    static_cast<unsigned long long>(stats.liveBlocks), static_cast<unsigned long long>(stats.liveBytes));
+
+    static constexpr std::size_t MAX_REPORTED_CALL_SITES = 32;
+    MemorySentinel::CallSite top[MAX_REPORTED_CALL_SITES];
+    numCallSites = numCallSites < MAX_REPORTED_CALL_SITES ? numCallSites : MAX_REPORTED_CALL_SITES;
+    const std::size_t count = readTopCallSites(top, numCallSites);
+    for (std::size_t i = 0; i < count; ++i) {
+        const char* symbol = "?";
+        std::uintptr_t offset = 0;
+#if defined(__clang__) || defined(__GNUC__)
+        Dl_info info;
+        if (dladdr(top[i].address, &info) != 0) {
+            if (info.dli_sname != nullptr) {
+                symbol = info.dli_sname;
+                offset = reinterpret_cast<std::uintptr_t>(top[i].address) - reinterpret_cast<std::uintptr_t>(info.dli_saddr);
+            } else if (info.dli_fname != nullptr) {
+                symbol = info.dli_fname;
+                offset = reinterpret_cast<std::uintptr_t>(top[i].address) - reinterpret_cast<std::uintptr_t>(info.dli_fbase);
+            }
+        }
+#endif
+        appendFormatted(buffer, bufferSize, position, "  #%zu %p %s+0x%llx - %llu allocations, %llu bytes\n",
+                        i + 1, top[i].address, symbol, static_cast<unsigned long long>(offset),
+                        static_cast<unsigned long long>(top[i].allocations),
+                        static_cast<unsigned long long>(top[i].allocatedBytes));
+    }
+    return position;
+}
+
+std::size_t MemorySentinelStatistics::formatTopTags(char* buffer, std::size_t bufferSize, std::size_t numTags) noexcept
+{
+    if (buffer == nullptr || bufferSize == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+    std::size_t position = 0;
+    appendFormatted(buffer, bufferSize, position, "top tags (by transgressions, bytes):\n");
+
+    static constexpr std::size_t MAX_REPORTED_TAGS = 32;
+    MemorySentinel::Tag top[MAX_REPORTED_TAGS];
+    numTags = numTags < MAX_REPORTED_TAGS ? numTags : MAX_REPORTED_TAGS;
+    const std::size_t count = readTopTags(top, numTags);
+    for (std::size_t i = 0; i < count; ++i) {
+        appendFormatted(buffer, bufferSize, position, "  #%zu %s - %llu transgressions, %llu allocations, %llu bytes\n",
+                        i + 1, top[i].name,
+                        static_cast<unsigned long long>(top[i].transgressions),
+                        static_cast<unsigned long long>(top[i].allocations),
+                        static_cast<unsigned long long>(top[i].allocatedBytes));
+    }
+    return position;
+}
+
+std::size_t MemorySentinelStatistics::formatTopReallocSites(char* buffer, std::size_t bufferSize, std::size_t numCallSites) noexcept
+{
+    if (buffer == nullptr || bufferSize == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+    std::size_t position = 0;
+    appendFormatted(buffer, bufferSize, position, "top realloc call sites (by small-step growths, copied bytes):\n");
+
+    static constexpr std::size_t MAX_REPORTED_REALLOC_SITES = 32;
+    MemorySentinel::ReallocSite top[MAX_REPORTED_REALLOC_SITES];
+    numCallSites = numCallSites < MAX_REPORTED_REALLOC_SITES ? numCallSites : MAX_REPORTED_REALLOC_SITES;
+    const std::size_t count = readTopReallocSites(top, numCallSites);
+    for (std::size_t i = 0; i < count; ++i) {
+        appendFormatted(buffer, bufferSize, position, "  #%zu %p - %llu growths (%llu small-step), %llu bytes copied, longest chain %llu\n",
+                        i + 1, top[i].address,
+                        static_cast<unsigned long long>(top[i].growingReallocations),
+                        static_cast<unsigned long long>(top[i].smallStepGrowths),
+                        static_cast<unsigned long long>(top[i].copiedBytes),
+                        static_cast<unsigned long long>(top[i].longestChain));
+    }
+    return position;
+}
+
+std::size_t MemorySentinelStatistics::formatSizeClasses(char* buffer, std::size_t bufferSize, double coverage) noexcept
+{
+    if (buffer == nullptr || bufferSize == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+    MemorySentinel::SizeClass histogram[MemorySentinel::NUM_SIZE_CLASSES];
+    const std::size_t numClasses = readSizeHistogram(histogram, MemorySentinel::NUM_SIZE_CLASSES);
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < numClasses; ++i) {
+        total += histogram[i].allocations;
+    }
+    std::size_t position = 0;
+    appendFormatted(buffer, bufferSize, position, "requested sizes (%llu allocations):\n", static_cast<unsigned long long>(total));
+    for (std::size_t i = 0; i < numClasses; ++i) {
+        appendFormatted(buffer, bufferSize, position, "  <= %llu: %llu\n", static_cast<unsigned long long>(histogram[i].maxSize),
+                        static_cast<unsigned long long>(histogram[i].allocations));
+    }
+    
+    MemorySentinel::SizeClass suggested[MemorySentinel::NUM_SIZE_CLASSES];
+    const std::size_t numSuggested = suggestSizeClasses(suggested, MemorySentinel::NUM_SIZE_CLASSES, coverage);
+    appendFormatted(buffer, bufferSize, position, "suggested slab size classes (%.0f%% of allocations):", coverage * 100.0);
+    for (std::size_t i = 0; i < numSuggested; ++i) {
+        appendFormatted(buffer, bufferSize, position, " %llu", static_cast<unsigned long long>(suggested[i].maxSize));
+    }
+    appendFormatted(buffer, bufferSize, position, "\n");
+    return position;
+}
@@ -0,0 +1,71 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#pragma once
+
+#include "MemorySentinel.hpp"
+
+#include <cstddef>
+
+/**
+ * Process-wide allocation counters and call-site table fed by the hooks.
+ * All functions are allocation-free, so they can be called from within new/delete and malloc/free.
+ */
+class MemorySentinelStatistics
+{
+public:
+    /**
+     * @param size requested number of bytes
+     * @param usableSize usable size of the block as reported by the platform allocator (0 if unknown)
+     * @param callSite return address of the allocation function
+     */
+    static void recordAllocation(std::size_t size, std::size_t usableSize, const void* callSite) noexcept;
+    static void recordDeallocation(std::size_t usableSize) noexcept;
+    /**
+     * Records a successful realloc of oldPtr to newPtr by the calling thread. Consecutive reallocs of the same block
+     * from the same call site form a chain. Only growing reallocs are counted (shrinking ones only extend the chain).
+     */
+    static void recordReallocation(const void* oldPtr, std::size_t oldSize, const void* newPtr, std::size_t newSize,
+                                   const void* callSite) noexcept;
+    static void recordPermittedAllocation() noexcept;
+    static void recordExemptAllocation() noexcept;
+    static void recordTransgression() noexcept;
+
+    static MemorySentinel::Statistics read() noexcept;
+    static std::size_t readTopCallSites(MemorySentinel::CallSite* result, std::size_t maxCount) noexcept;
+    static std::size_t readTopReallocSites(MemorySentinel::ReallocSite* result, std::size_t maxCount) noexcept;
+    static std::size_t readSizeHistogram(MemorySentinel::SizeClass* result, std::size_t maxCount) noexcept;
+    static std::size_t suggestSizeClasses(MemorySentinel::SizeClass* result, std::size_t maxCount, double coverage) noexcept;
+    static void reset() noexcept;
+
+    /** Writes a human-readable summary into buffer (always null-terminated). Returns the number of chars written. */
+    static std::size_t format(char* buffer, std::size_t bufferSize) noexcept;
+
+    /** Like format(), followed by the live heap summary and the top call sites (symbolized where possible) */
+    static std::size_t formatHeapProfile(char* buffer, std::size_t bufferSize, std::size_t numCallSites = 10) noexcept;
+
+    /** Writes the realloc call sites with the most small-step growths. Returns the number of chars written. */
+    static std::size_t formatTopReallocSites(char* buffer, std::size_t bufferSize, std::size_t numCallSites = 10) noexcept;
+
+    /** Writes the size histogram and the suggested slab size classes. Returns the number of chars written. */
+    static std::size_t formatSizeClasses(char* buffer, std::size_t bufferSize, double coverage = 0.95) noexcept;
+
+    /**
+     * Returns the slot of tag in the lock-free tag table, claiming a new one if needed (-1 if the table is full).
+     * Tags are interned by content: the first pointer registered for a string is the key for all equal strings.
+     */
+    static int internTag(const char* tag) noexcept;
+    /** Interns the tag "label [qualifier]", composed in a private pool on first use (nullptr parts are omitted) */
+    static int internTag(const char* label, const char* qualifier) noexcept;
+    static void recordTagAllocation(int tagIndex, std::size_t size) noexcept;
+    static void recordTagTransgression(int tagIndex) noexcept;
+    static std::size_t readTopTags(MemorySentinel::Tag* result, std::size_t maxCount) noexcept;
+
+    /** Writes the top offending tags (by transgressions, then bytes) into buffer. Returns the number of chars written. */
+    static std::size_t formatTopTags(char* buffer, std::size_t bufferSize, std::size_t numTags = 10) noexcept;
+};
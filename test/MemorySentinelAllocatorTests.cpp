@@ -0,0 +1,97 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include <catch2/catch.hpp>
+
+#include "MemorySentinelAllocator.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+static const MemorySentinel::Tag* findTagWithPrefix(const MemorySentinel::Tag* tags, std::size_t count, const char* prefix)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        if (strncmp(tags[i].name, prefix, strlen(prefix)) == 0) {
+            return &tags[i];
+        }
+    }
+    return nullptr;
+}
+
+TEST_CASE("SentinelAllocator Tests")
+{
+    MemorySentinel::resetStatistics();
+    
+    SECTION("type names") {
+        REQUIRE(strcmp(MemorySentinelTypeName<int>::get(), "int") == 0);
+        REQUIRE(strstr(MemorySentinelTypeName<std::pair<int, float>>::get(), "pair") != nullptr);
+        REQUIRE(SentinelAllocator<int>("a") == SentinelAllocator<float>("b"));
+    }
+    
+    SECTION("allocations are attributed to the container's tag") {
+        using Lookup = std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, SentinelAllocator<std::pair<const int, int>>>;
+        constexpr int numValues = 100;
+        constexpr int numEntries = 50;
+        MemorySentinel::setStatisticsEnabled(true);
+        {
+            std::vector<int, SentinelAllocator<int>> values(SentinelAllocator<int>("test.values"));
+            for (int i = 0; i < numValues; ++i) {
+                values.push_back(i);
+            }
+            Lookup lookup(16, std::hash<int>(), std::equal_to<int>(), Lookup::allocator_type("test.lookup"));
+            for (int i = 0; i < numEntries; ++i) {
+                lookup[i] = i;
+            }
+            std::vector<double, SentinelAllocator<double>> unlabeled(4);
+        }
+        MemorySentinel::setStatisticsEnabled(false);
+        
+        MemorySentinel::Tag top[16];
+        const std::size_t count = MemorySentinel::getTopTags(top, 16);
+        const MemorySentinel::Tag* values = findTagWithPrefix(top, count, "test.values [int]");
+        REQUIRE(values != nullptr);
+        REQUIRE(values->allocations >= 1);
+        REQUIRE(values->allocatedBytes >= numValues * sizeof(int));
+        
+        const MemorySentinel::Tag* lookup = findTagWithPrefix(top, count, "test.lookup [");
+        REQUIRE(lookup != nullptr);
+        REQUIRE(strstr(lookup->name, "pair") != nullptr); // rebound allocators keep the tag of the container
+        REQUIRE(lookup->allocations >= numEntries);
+        
+        const MemorySentinel::Tag* unlabeled = findTagWithPrefix(top, count, "double");
+        REQUIRE(unlabeled != nullptr);
+        REQUIRE(unlabeled->allocations == 1);
+        
+        // recorded once (the heap allocations of the allocator are not counted again by the hooks)
+        REQUIRE(MemorySentinel::getStatistics().allocations == values->allocations + lookup->allocations + unlabeled->allocations);
+    }
+    
+    SECTION("subject to the armed sentinel") {
+        std::vector<int, SentinelAllocator<int>> values(SentinelAllocator<int>("test.armed"));
+        MemorySentinel::Scope result;
+        {
+            ScopedMemorySentinel sentinel(0, MemorySentinel::TransgressionBehaviour::SILENT);
+            values.push_back(1);
+            result = sentinel.getScope();
+        }
+        REQUIRE(result.transgressions == 1);
+    }
+    
+    SECTION("oversized requests are rejected") {
+        SentinelAllocator<double> allocator("test.oversized");
+        REQUIRE(allocator.max_size() == SIZE_MAX / sizeof(double));
+        REQUIRE_THROWS_AS(allocator.allocate(allocator.max_size() + 1), std::bad_array_new_length);
+        REQUIRE_THROWS_AS(allocator.allocate(SIZE_MAX), std::bad_array_new_length);
+    }
+    
+    MemorySentinel::resetStatistics();
+}
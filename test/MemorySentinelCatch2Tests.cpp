@@ -0,0 +1,108 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include <catch2/catch.hpp>
+
+#include "MemorySentinelCatch2.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST_CASE("Catch2 integration Tests", "[catch2]")
+{
+    SECTION("thread counters") {
+        const MemorySentinel::ThreadCounters before = MemorySentinel::getThreadCounters();
+        delete[] new float[32];
+        const MemorySentinel::ThreadCounters after = MemorySentinel::getThreadCounters();
+        REQUIRE(after.allocations - before.allocations == 1);
+        REQUIRE(after.deallocations - before.deallocations == 1);
+        REQUIRE(after.allocatedBytes - before.allocatedBytes == sizeof(float[32]));
+    }
+    
+    SECTION("counted without statistics, unaffected by a reset") {
+        MemorySentinel::setStatisticsEnabled(false);
+        const MemorySentinel::ThreadCounters before = MemorySentinel::getThreadCounters();
+        auto value = std::make_unique<int>(42);
+        MemorySentinel::resetStatistics();
+        REQUIRE(MemorySentinel::getThreadCounters().allocations - before.allocations == 1);
+    }
+    
+    SECTION("budget") {
+        std::vector<int> values;
+        values.reserve(64);
+        {
+            SLB_ALLOCATION_BUDGET(0);
+            for (int i = 0; i < 64; ++i) {
+                values.push_back(i);
+            }
+        }
+        {
+            SLB_ALLOCATION_BUDGET(1, 256 * sizeof(int));
+            values.reserve(256);
+        }
+    }
+}
+
+TEST_CASE("Allocation baseline Tests", "[catch2]")
+{
+    using Entry = MemorySentinelBaseline::Entry;
+    const std::string path = "MemorySentinelBaselineTest.txt";
+    
+    SECTION("round trip") {
+        MemorySentinelBaseline written;
+        written.set("Test / with spaces", Entry{3, 96});
+        written.set("Other", Entry{0, 0});
+        REQUIRE(written.save(path));
+        
+        MemorySentinelBaseline read;
+        REQUIRE(read.load(path));
+        REQUIRE(read.getEntries().size() == 2);
+        REQUIRE(read.find("Test / with spaces") != nullptr);
+        REQUIRE(read.find("Test / with spaces")->allocations == 3);
+        REQUIRE(read.find("Test / with spaces")->allocatedBytes == 96);
+        REQUIRE_FALSE(read.load("does/not/exist.txt"));
+        std::remove(path.c_str());
+    }
+    
+    SECTION("regressions") {
+        MemorySentinelBaseline baseline;
+        baseline.set("hot path", Entry{0, 0});
+        baseline.set("setup", Entry{10, 1000});
+        std::string description;
+        REQUIRE_FALSE(baseline.isRegression("hot path", Entry{0, 0}));
+        REQUIRE(baseline.isRegression("hot path", Entry{1, 8}, &description));
+        REQUIRE(description.find("'hot path': 1 allocations / 8 bytes") != std::string::npos);
+        REQUIRE_FALSE(baseline.isRegression("setup", Entry{9, 1000}));
+        REQUIRE(baseline.isRegression("setup", Entry{11, 1000}));
+        REQUIRE(baseline.isRegression("setup", Entry{10, 1001}));
+        REQUIRE_FALSE(baseline.isRegression("unknown", Entry{100, 100}));
+        
+        baseline.setTolerance(0.1);
+        REQUIRE_FALSE(baseline.isRegression("setup", Entry{11, 1100}));
+        REQUIRE(baseline.isRegression("setup", Entry{12, 1100}));
+        REQUIRE(baseline.isRegression("hot path", Entry{1, 8})); // no tolerance on zero
+    }
+    
+    SECTION("tags") {
+        MemorySentinel::resetStatistics();
+        MemorySentinel::setStatisticsEnabled(true);
+        {
+            ScopedMemorySentinel sentinel("test.baseline", 1024);
+            delete new int;
+        }
+        MemorySentinel::setStatisticsEnabled(false);
+        MemorySentinelBaseline baseline;
+        baseline.setTags();
+        REQUIRE(baseline.find("tag:test.baseline") != nullptr);
+        REQUIRE(baseline.find("tag:test.baseline")->allocations == 1);
+        REQUIRE(baseline.find("tag:test.baseline")->allocatedBytes == sizeof(int));
+        MemorySentinel::resetStatistics();
+    }
+}
@@ -0,0 +1,298 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include <catch2/catch.hpp>
+
+#include "MemorySentinel.hpp"
+#include "MemorySentinelControl.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+    #ifndef MSG_NOSIGNAL
+        #define MSG_NOSIGNAL 0 // macOS: SO_NOSIGPIPE is set on the connection instead
+    #endif
+#endif
+
+TEST_CASE("MemorySentinelControl Tests: commands")
+{
+    char reply[1024];
+    
+    SECTION("arm / disarm") {
+        REQUIRE(MemorySentinelControl::executeCommand("arm", reply, sizeof(reply)));
+        REQUIRE(MemorySentinel::getConfig().hijackActive);
+        REQUIRE(MemorySentinelControl::executeCommand("disarm", reply, sizeof(reply)));
+        REQUIRE_FALSE(MemorySentinel::getConfig().hijackActive);
+        REQUIRE(std::string(reply) == "ok\n");
+        REQUIRE(MemorySentinel::isDisarmOverridden());
+        MemorySentinel::setDisarmOverride(false);
+    }
+    
+    SECTION("disarm while another thread holds the sentinel armed") {
+        std::atomic<bool> isOtherThreadArmed { false };
+        std::atomic<bool> isDisarmSent { false };
+        std::atomic<bool> wasTransgressionRecorded { true };
+        std::thread armedThread([&] {
+            ScopedMemorySentinel sentinel(0, MemorySentinel::TransgressionBehaviour::SILENT);
+            isOtherThreadArmed.store(true);
+            while (!isDisarmSent.load()) {
+                std::this_thread::yield();
+            }
+            auto* allowedNow = new int(7);
+            delete allowedNow;
+            wasTransgressionRecorded.store(MemorySentinel::getInstance().hasTransgressionOccured());
+        });
+        while (!isOtherThreadArmed.load()) {
+            std::this_thread::yield();
+        }
+        REQUIRE(MemorySentinel::getConfig().hijackActive);
+        REQUIRE(MemorySentinelControl::executeCommand("disarm", reply, sizeof(reply)));
+        REQUIRE(std::string(reply) == "ok\n");
+        REQUIRE_FALSE(MemorySentinel::getConfig().hijackActive);
+        isDisarmSent.store(true);
+        armedThread.join();
+        REQUIRE_FALSE(wasTransgressionRecorded.load());
+        
+        REQUIRE(MemorySentinelControl::executeCommand("arm", reply, sizeof(reply)));
+        REQUIRE_FALSE(MemorySentinel::isDisarmOverridden());
+        REQUIRE(MemorySentinel::getConfig().hijackActive);
+        MemorySentinel::getInstance().setArmed(false);
+    }
+    
+    SECTION("behaviour") {
+        REQUIRE(MemorySentinelControl::executeCommand("behaviour silent", reply, sizeof(reply)));
+        REQUIRE(MemorySentinel::getTransgressionBehaviour() == MemorySentinel::TransgressionBehaviour::SILENT);
+        REQUIRE(MemorySentinelControl::executeCommand("behaviour throw", reply, sizeof(reply)));
+        REQUIRE(MemorySentinel::getTransgressionBehaviour() == MemorySentinel::TransgressionBehaviour::THROW_EXCEPTION);
+        REQUIRE(MemorySentinelControl::executeCommand("behaviour log", reply, sizeof(reply)));
+        REQUIRE(MemorySentinel::getTransgressionBehaviour() == MemorySentinel::TransgressionBehaviour::LOG);
+        REQUIRE_FALSE(MemorySentinelControl::executeCommand("behaviour panic", reply, sizeof(reply)));
+    }
+    
+    SECTION("quota") {
+        REQUIRE(MemorySentinelControl::executeCommand("quota 128", reply, sizeof(reply)));
+        REQUIRE(MemorySentinel::getRemainingAllocationQuota() == 128);
+        REQUIRE(MemorySentinelControl::executeCommand("quota 0", reply, sizeof(reply)));
+        REQUIRE(MemorySentinel::getRemainingAllocationQuota() == 0);
+        REQUIRE_FALSE(MemorySentinelControl::executeCommand("quota lots", reply, sizeof(reply)));
+        REQUIRE(std::string(reply) == "error: invalid argument 'lots'\n");
+        // out of range or negative: rejected rather than truncated
+        REQUIRE_FALSE(MemorySentinelControl::executeCommand("quota 3000000000", reply, sizeof(reply)));
+        REQUIRE_FALSE(MemorySentinelControl::executeCommand("quota 99999999999999999999999", reply, sizeof(reply)));
+        REQUIRE_FALSE(MemorySentinelControl::executeCommand("quota -5", reply, sizeof(reply)));
+        REQUIRE(std::string(reply) == "error: invalid argument '-5'\n");
+        REQUIRE(MemorySentinel::getRemainingAllocationQuota() == 0);
+    }
+    
+    SECTION("statistics & sampling") {
+        REQUIRE(MemorySentinelControl::executeCommand("sampling 4", reply, sizeof(reply)));
+        REQUIRE(MemorySentinel::getSamplingInterval() == 4);
+        REQUIRE_FALSE(MemorySentinelControl::executeCommand("sampling 0", reply, sizeof(reply)));
+        REQUIRE_FALSE(MemorySentinelControl::executeCommand("sampling -2", reply, sizeof(reply)));
+        REQUIRE_FALSE(MemorySentinelControl::executeCommand("sampling 4294967297", reply, sizeof(reply)));
+        REQUIRE(MemorySentinel::getSamplingInterval() == 4);
+        REQUIRE(MemorySentinelControl::executeCommand("sampling 1", reply, sizeof(reply)));
+        
+        REQUIRE(MemorySentinelControl::executeCommand("reset", reply, sizeof(reply)));
+        REQUIRE(MemorySentinelControl::executeCommand("statistics on", reply, sizeof(reply)));
+        REQUIRE(MemorySentinel::isStatisticsEnabled());
+        auto* heapObject = new std::vector<float>(32);
+        delete heapObject;
+        REQUIRE(MemorySentinelControl::executeCommand("statistics off", reply, sizeof(reply)));
+        REQUIRE(MemorySentinel::getStatistics().allocations >= 2);
+        REQUIRE(MemorySentinel::getStatistics().deallocations >= 2);
+        
+        REQUIRE(MemorySentinelControl::executeCommand("stats", reply, sizeof(reply)));
+        REQUIRE(std::strstr(reply, "allocations: ") != nullptr);
+        REQUIRE(MemorySentinelControl::executeCommand("reset", reply, sizeof(reply)));
+        REQUIRE(MemorySentinel::getStatistics().allocations == 0);
+    }
+    
+    SECTION("unknown command") {
+        REQUIRE_FALSE(MemorySentinelControl::executeCommand("armed", reply, sizeof(reply)));
+        REQUIRE(std::string(reply) == "error: unknown command 'armed'\n");
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST_CASE("MemorySentinelControl Tests: unix socket")
+{
+    const std::string socketPath = "/tmp/memorysentinel-test-" + std::to_string(getpid()) + ".sock";
+    REQUIRE(MemorySentinelControl::start(socketPath.c_str()));
+    REQUIRE(MemorySentinelControl::isRunning());
+    REQUIRE_FALSE(MemorySentinelControl::start(socketPath.c_str())); // already running
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(fd >= 0);
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    
+    const std::string commands = "behaviour silent\nstats\n";
+    REQUIRE(write(fd, commands.data(), commands.size()) == static_cast<ssize_t>(commands.size()));
+    shutdown(fd, SHUT_WR);
+    
+    std::string response;
+    char buffer[256];
+    ssize_t received;
+    while ((received = read(fd, buffer, sizeof(buffer))) > 0) {
+        response.append(buffer, static_cast<std::size_t>(received));
+    }
+    close(fd);
+    
+    REQUIRE(response.compare(0, 3, "ok\n") == 0);
+    REQUIRE(response.find("allocations: ") != std::string::npos);
+    REQUIRE(MemorySentinel::getTransgressionBehaviour() == MemorySentinel::TransgressionBehaviour::SILENT);
+    MemorySentinel::setTransgressionBehaviour(MemorySentinel::TransgressionBehaviour::LOG);
+    
+    MemorySentinelControl::stop();
+    REQUIRE_FALSE(MemorySentinelControl::isRunning());
+    REQUIRE(access(socketPath.c_str(), F_OK) != 0); // socket file removed
+}
+
+static int connectToControlSocket(const std::string& socketPath)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+TEST_CASE("MemorySentinelControl Tests: socket path is not a socket")
+{
+    const std::string path = "/tmp/memorysentinel-test-file-" + std::to_string(getpid()) + ".sock";
+    FILE* file = std::fopen(path.c_str(), "w");
+    REQUIRE(file != nullptr);
+    std::fputs("precious", file);
+    std::fclose(file);
+    
+    REQUIRE_FALSE(MemorySentinelControl::start(path.c_str()));
+    REQUIRE_FALSE(MemorySentinelControl::isRunning());
+    REQUIRE(access(path.c_str(), F_OK) == 0); // the regular file was left alone
+    std::remove(path.c_str());
+    
+    // a stale socket from a previous run is replaced
+    REQUIRE(MemorySentinelControl::start(path.c_str()));
+    MemorySentinelControl::stop();
+    int staleSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    REQUIRE(bind(staleSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    close(staleSocket);
+    REQUIRE(MemorySentinelControl::start(path.c_str()));
+    MemorySentinelControl::stop();
+    REQUIRE(access(path.c_str(), F_OK) != 0);
+}
+
+TEST_CASE("MemorySentinelControl Tests: a busy client does not block stop")
+{
+    const std::string socketPath = "/tmp/memorysentinel-test-busy-" + std::to_string(getpid()) + ".sock";
+    REQUIRE(MemorySentinelControl::start(socketPath.c_str()));
+    
+    std::atomic<bool> clientDone { false };
+    std::thread client([&] {
+        // reconnects whenever the server ends the connection, and never pauses long enough for the receive timeout
+        while (!clientDone.load()) {
+            int fd = connectToControlSocket(socketPath);
+            if (fd < 0) {
+                break; // server is gone
+            }
+            const char command[] = "reset\n";
+            while (!clientDone.load() && send(fd, command, sizeof(command) - 1, MSG_NOSIGNAL) > 0) {
+                char buffer[64];
+                recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            }
+            close(fd);
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    
+    const auto before = std::chrono::steady_clock::now();
+    MemorySentinelControl::stop();
+    const auto elapsed = std::chrono::steady_clock::now() - before;
+    clientDone.store(true);
+    client.join();
+    
+    REQUIRE_FALSE(MemorySentinelControl::isRunning());
+    REQUIRE(elapsed < std::chrono::milliseconds(900)); // well below the 1 s receive timeout
+}
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+static std::string readFileWhenNotEmpty(const std::string& path, const char* expected)
+{
+    std::string content;
+    for (int attempt = 0; attempt < 200; ++attempt) { // dump happens asynchronously on the dump thread
+        content.clear();
+        if (FILE* file = std::fopen(path.c_str(), "r")) {
+            char buffer[512];
+            std::size_t n;
+            while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+                content.append(buffer, n);
+            }
+            std::fclose(file);
+        }
+        if (content.find(expected) != std::string::npos) {
+            break;
+        }
+        usleep(5000);
+    }
+    return content;
+}
+
+TEST_CASE("MemorySentinelControl Tests: signal-triggered dump")
+{
+    const std::string dumpPath = "/tmp/memorysentinel-dump-" + std::to_string(getpid()) + ".txt";
+    std::remove(dumpPath.c_str());
+    
+    REQUIRE(MemorySentinelControl::startSignalDump(dumpPath.c_str()));
+    REQUIRE(MemorySentinelControl::isSignalDumpRunning());
+    REQUIRE_FALSE(MemorySentinelControl::startSignalDump(dumpPath.c_str())); // already running
+    
+    MemorySentinel::setStatisticsEnabled(true);
+    auto* heapObject = new std::vector<float>(32);
+    MemorySentinel::setStatisticsEnabled(false);
+    
+    raise(SIGUSR1);
+    std::string content = readFileWhenNotEmpty(dumpPath, "transgressions: ");
+    REQUIRE(content.find("=== MemorySentinel statistics") != std::string::npos);
+    REQUIRE(content.find("live bytes") == std::string::npos);
+    
+    raise(SIGUSR2);
+    content = readFileWhenNotEmpty(dumpPath, "top call sites");
+    REQUIRE(content.find("=== MemorySentinel heap profile") != std::string::npos);
+    REQUIRE(content.find("live bytes: ") != std::string::npos);
+    REQUIRE(content.find("  #1 ") != std::string::npos);
+    
+    MemorySentinelControl::stopSignalDump();
+    REQUIRE_FALSE(MemorySentinelControl::isSignalDumpRunning());
+    delete heapObject;
+    std::remove(dumpPath.c_str());
+}
+#endif
@@ -0,0 +1,175 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include <catch2/catch.hpp>
+
+#include "MemorySentinel.hpp"
+#include "MemorySentinelControl.hpp"
+#include "MemorySentinelSampler.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <atomic>
+    #include <chrono>
+    #include <csignal>
+    #include <string>
+    #include <thread>
+    #include <vector>
+
+    #include <fcntl.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+
+/**
+ * Forks and runs check() in the child, whose result becomes its exit status (Catch's assertions are not usable there).
+ * Returns the exit status, or -1 if the child did not exit within a few seconds (e.g. deadlocked), or crashed.
+ */
+template<class Check>
+static int runInChild(Check check)
+{
+    const pid_t pid = fork();
+    if (pid == 0) {
+        _exit(check() ? 0 : 1);
+    }
+    if (pid < 0) {
+        return -1;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    int status = 0;
+    while (waitpid(pid, &status, WNOHANG) == 0) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            return -1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/** Counts the open file descriptors that an exec'd program would inherit. */
+static int countInheritableFileDescriptors()
+{
+    int count = 0;
+    for (int fd = 0; fd < 1024; ++fd) {
+        const int flags = fcntl(fd, F_GETFD);
+        if (flags >= 0 && (flags & FD_CLOEXEC) == 0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+TEST_CASE("MemorySentinel Fork Tests")
+{
+    REQUIRE(MemorySentinel::installForkHandlers());
+    REQUIRE(MemorySentinel::installForkHandlers()); // idempotent
+
+    SECTION("unarmed fork with background threads") {
+        const std::string socketPath = "/tmp/memorysentinel-fork-" + std::to_string(getpid()) + ".sock";
+        MemorySentinel::resetStatistics();
+        MemorySentinel::setStatisticsEnabled(true);
+        REQUIRE(MemorySentinelSampler::start(1));
+        REQUIRE(MemorySentinelControl::start(socketPath.c_str()));
+        std::vector<int> block(100);
+        REQUIRE(MemorySentinel::getStatistics().allocations > 0);
+
+        const int status = runInChild([&socketPath]() {
+            bool ok = !MemorySentinelSampler::isRunning() && !MemorySentinelControl::isRunning();
+            ok = ok && MemorySentinel::getStatistics().allocations == 0;
+            ok = ok && MemorySentinel::getThreadCounters().allocations == 0;
+            MemorySentinelSampler::stop();  // returns: there is no thread to join
+            MemorySentinelControl::stop();
+            ok = ok && access(socketPath.c_str(), F_OK) == 0; // the parent's socket is left alone
+            MemorySentinel::setSamplingInterval(1); // the configuration can still be updated
+            ok = ok && MemorySentinelSampler::start(1); // and the background threads restarted
+            MemorySentinelSampler::stop();
+            return ok;
+        });
+        REQUIRE(status == 0);
+
+        // the parent is unaffected
+        REQUIRE(MemorySentinelSampler::isRunning());
+        REQUIRE(MemorySentinelControl::isRunning());
+        MemorySentinelControl::stop();
+        MemorySentinelSampler::stop();
+        REQUIRE(access(socketPath.c_str(), F_OK) != 0);
+        MemorySentinel::setStatisticsEnabled(false);
+    }
+
+    SECTION("pipes and sockets are not inherited across exec") {
+        const std::string socketPath = "/tmp/memorysentinel-cloexec-" + std::to_string(getpid()) + ".sock";
+        const int before = countInheritableFileDescriptors();
+        REQUIRE(MemorySentinelSampler::start(1));
+        REQUIRE(MemorySentinelControl::start(socketPath.c_str()));
+        REQUIRE(MemorySentinelControl::startSignalDump("/dev/null"));
+        REQUIRE(countInheritableFileDescriptors() == before);
+        MemorySentinelControl::stopSignalDump();
+        MemorySentinelControl::stop();
+        MemorySentinelSampler::stop();
+    }
+
+    SECTION("armed fork") {
+        {
+            ScopedMemorySentinel sentinel(0, MemorySentinel::TransgressionBehaviour::SILENT);
+            const int status = runInChild([]() {
+                MemorySentinel& instance = MemorySentinel::getInstance();
+                bool ok = !MemorySentinel::getConfig().hijackActive;
+                std::vector<int> block(100);
+                return ok && !instance.getAndClearTransgressionsOccured();
+            });
+            REQUIRE(status == 0);
+
+            // the parent is still armed
+            REQUIRE(MemorySentinel::getConfig().hijackActive);
+            MemorySentinel::getInstance().clearTransgressions();
+        }
+        REQUIRE_FALSE(MemorySentinel::getConfig().hijackActive);
+    }
+
+    SECTION("fork while other threads update the configuration and allocate") {
+        REQUIRE(MemorySentinel::setLiveAllocationTrackingEnabled(true));
+        std::vector<int> held(100); // tracked, live in the parent (and inherited by the child)
+        std::atomic<bool> isDone { false };
+        std::thread writer([&isDone]() {
+            for (int i = 0; !isDone.load(); ++i) {
+                MemorySentinel::setStatisticsEnabled(i % 2 == 0);
+            }
+        });
+        std::thread reader([&isDone]() {
+            while (!isDone.load()) {
+                std::vector<int> block(10);
+            }
+        });
+        for (int i = 0; i < 20; ++i) {
+            const int status = runInChild([]() {
+                MemorySentinel::setStatisticsEnabled(false); // would wait forever for an inherited lock or reader
+                bool ok = !MemorySentinel::isStatisticsEnabled();
+                // the child's table is empty: neither the parent's blocks nor slots left half-filled by other threads
+                const int devNull = open("/dev/null", O_WRONLY);
+                const std::size_t inherited = MemorySentinel::writeLeakReport(devNull);
+                auto* block = new int[16];
+                const std::size_t own = MemorySentinel::writeLeakReport(devNull);
+                delete[] block;
+                close(devNull);
+                return ok && inherited == 0 && own == 1;
+            });
+            REQUIRE(status == 0);
+        }
+        isDone.store(true);
+        writer.join();
+        reader.join();
+        MemorySentinel::setStatisticsEnabled(false);
+
+        // the parent's table is untouched
+        const int devNull = open("/dev/null", O_WRONLY);
+        REQUIRE(MemorySentinel::writeLeakReport(devNull) >= 1);
+        close(devNull);
+        REQUIRE(MemorySentinel::setLiveAllocationTrackingEnabled(false));
+    }
+}
+#endif
@@ -0,0 +1,188 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include <catch2/catch.hpp>
+
+#include "MemorySentinel.hpp"
+#include "MemorySentinelLiveAllocations.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#if defined(__clang__) || defined(__GNUC__)
+    #define NOINLINE __attribute__((noinline))
+#else
+    #define NOINLINE __declspec(noinline)
+#endif
+
+static NOINLINE float* allocateLeakCandidate() { return new float[300]; }
+static NOINLINE float* allocateShortLived() { return new float[16]; }
+static NOINLINE float* allocateLongLived() { return new float[16]; }
+
+/** Writes the leak report into a temporary file and returns its contents */
+static std::string readLeakReport(const char* scopeTag, std::size_t& numBlocks)
+{
+    std::FILE* file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    numBlocks = MemorySentinel::writeLeakReport(fileno(file), scopeTag);
+    std::rewind(file);
+    std::string report;
+    char buffer[256];
+    while (std::fgets(buffer, sizeof(buffer), file) != nullptr) {
+        report += buffer;
+    }
+    std::fclose(file);
+    return report;
+}
+
+TEST_CASE("MemorySentinelLiveAllocations Tests: leak report")
+{
+#if defined(__unix__) || defined(__APPLE__)
+    REQUIRE(MemorySentinel::setLiveAllocationTrackingEnabled(true));
+    REQUIRE(MemorySentinel::isLiveAllocationTrackingEnabled());
+    
+    float* leakedInScope[2];
+    {
+        ScopedMemorySentinel sentinel("test.leaks", 0, MemorySentinel::TransgressionBehaviour::SILENT);
+        for (float*& block : leakedInScope) {
+            block = allocateLeakCandidate(); // same stack
+        }
+        delete[] allocateLeakCandidate(); // freed: not reported
+    }
+    float* leakedOutsideScope = allocateLeakCandidate();
+    
+    std::size_t numBlocks = 0;
+    std::string report = readLeakReport("test.leaks", numBlocks);
+    REQUIRE(numBlocks == 2);
+    REQUIRE(report.find("2 blocks, 2400 bytes still alive (1 stacks)") != std::string::npos);
+    REQUIRE(report.find("#1 2400 bytes in 2 blocks") != std::string::npos);
+    
+    // all blocks: the ones leaked within the scope are part of it
+    report = readLeakReport(nullptr, numBlocks);
+    REQUIRE(numBlocks >= 3);
+    
+    delete[] leakedInScope[0];
+    delete[] leakedInScope[1];
+    delete[] leakedOutsideScope;
+    report = readLeakReport("test.leaks", numBlocks);
+    REQUIRE(numBlocks == 0);
+    REQUIRE(report.find("0 blocks, 0 bytes still alive") != std::string::npos);
+    
+    readLeakReport("test.no_such_scope", numBlocks);
+    REQUIRE(numBlocks == 0);
+    
+    REQUIRE(MemorySentinel::setLiveAllocationTrackingEnabled(false));
+    float* untracked = allocateLeakCandidate();
+    readLeakReport(nullptr, numBlocks);
+    const std::size_t numBlocksWithUntracked = numBlocks;
+    delete[] untracked;
+    readLeakReport(nullptr, numBlocks);
+    REQUIRE(numBlocks == numBlocksWithUntracked);
+#endif
+}
+
+TEST_CASE("MemorySentinelLiveAllocations Tests: lifetime histograms")
+{
+#if defined(__unix__) || defined(__APPLE__)
+    REQUIRE(MemorySentinel::setLiveAllocationTrackingEnabled(true));
+    MemorySentinel::resetStatistics();
+    
+    constexpr int numShortLived = 100;
+    constexpr int numLongLived = 5;
+    for (int i = 0; i < numShortLived; ++i) {
+        delete[] allocateShortLived();
+    }
+    float* longLived[numLongLived];
+    for (float*& block : longLived) {
+        block = allocateLongLived();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    for (float* block : longLived) {
+        delete[] block;
+    }
+    REQUIRE(MemorySentinel::setLiveAllocationTrackingEnabled(false));
+    
+    MemorySentinel::LifetimeHistogram histograms[16];
+    const std::size_t count = MemorySentinel::getLifetimeHistograms(histograms, 16);
+    const MemorySentinel::LifetimeHistogram* shortLived = nullptr;
+    const MemorySentinel::LifetimeHistogram* longLivedHistogram = nullptr;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            REQUIRE(histograms[i-1].frees >= histograms[i].frees);
+        }
+        shortLived = histograms[i].frees == numShortLived ? &histograms[i] : shortLived;
+        longLivedHistogram = histograms[i].frees == numLongLived ? &histograms[i] : longLivedHistogram;
+    }
+    REQUIRE(shortLived != nullptr);
+    REQUIRE(longLivedHistogram != nullptr);
+    REQUIRE(shortLived->address != longLivedHistogram->address);
+    
+    // 20 ms > 2^24 ns: all long-lived blocks are in the buckets above
+    std::uint64_t longLivedInUpperBuckets = 0;
+    for (std::size_t bucket = 24; bucket < MemorySentinel::NUM_LIFETIME_BUCKETS; ++bucket) {
+        longLivedInUpperBuckets += longLivedHistogram->buckets[bucket];
+    }
+    REQUIRE(longLivedInUpperBuckets == numLongLived);
+    REQUIRE(longLivedHistogram->totalLifetimeNs / numLongLived >= 20000000);
+    REQUIRE(shortLived->totalLifetimeNs / numShortLived < longLivedHistogram->totalLifetimeNs / numLongLived);
+    
+    std::FILE* file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    MemorySentinel::writeLifetimeReport(fileno(file), 4);
+    std::rewind(file);
+    char firstLine[256] = {};
+    REQUIRE(std::fgets(firstLine, sizeof(firstLine), file) != nullptr);
+    std::fclose(file);
+    REQUIRE(std::string(firstLine).find("object lifetimes") != std::string::npos);
+    
+    MemorySentinel::resetStatistics();
+    REQUIRE(MemorySentinel::getLifetimeHistograms(histograms, 16) == 0);
+#endif
+}
+
+TEST_CASE("MemorySentinelLiveAllocations Tests: racing deallocations")
+{
+#if defined(__unix__) || defined(__APPLE__)
+    REQUIRE(MemorySentinel::setLiveAllocationTrackingEnabled(true));
+    MemorySentinel::resetStatistics();
+    
+    // fake blocks, recorded directly: freeing a real block twice would be undefined behaviour
+    constexpr int numBlocks = 2000;
+    static const char callSite = 0;
+    static char blocks[numBlocks];
+    for (char& block : blocks) {
+        MemorySentinelLiveAllocations::recordAllocation(&block, 1, &callSite, -1);
+    }
+    std::atomic<int> numReady { 0 };
+    auto deallocateAll = [&] {
+        numReady.fetch_add(1);
+        while (numReady.load() < 2) {}
+        for (char& block : blocks) {
+            MemorySentinelLiveAllocations::recordDeallocation(&block);
+        }
+    };
+    std::thread other(deallocateAll);
+    deallocateAll();
+    other.join();
+    REQUIRE(MemorySentinel::setLiveAllocationTrackingEnabled(false));
+    
+    MemorySentinel::LifetimeHistogram histograms[16];
+    const std::size_t count = MemorySentinel::getLifetimeHistograms(histograms, 16);
+    const MemorySentinel::LifetimeHistogram* fakeBlocks = nullptr;
+    for (std::size_t i = 0; i < count; ++i) {
+        fakeBlocks = histograms[i].address == &callSite ? &histograms[i] : fakeBlocks;
+    }
+    REQUIRE(fakeBlocks != nullptr);
+    REQUIRE(fakeBlocks->frees == numBlocks); // each block is recorded by exactly one of the two threads
+    MemorySentinel::resetStatistics();
+#endif
+}
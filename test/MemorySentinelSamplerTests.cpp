@@ -0,0 +1,138 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include <catch2/catch.hpp>
+
+#include "MemorySentinel.hpp"
+#include "MemorySentinelSampler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** Runs write(fd) on a temporary file and returns its contents */
+template<class Writer>
+static std::string captureOutput(Writer write)
+{
+    std::FILE* file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    REQUIRE(write(fileno(file)));
+    std::rewind(file);
+    std::string output;
+    char buffer[256];
+    while (std::fgets(buffer, sizeof(buffer), file) != nullptr) {
+        output += buffer;
+    }
+    std::fclose(file);
+    return output;
+}
+
+TEST_CASE("MemorySentinelSampler Tests")
+{
+#if defined(__unix__) || defined(__APPLE__)
+    MemorySentinel::resetStatistics();
+    MemorySentinel::setStatisticsEnabled(true);
+    
+    REQUIRE_FALSE(MemorySentinelSampler::start(0));
+    REQUIRE(MemorySentinelSampler::start(1));
+    REQUIRE(MemorySentinelSampler::isRunning());
+    REQUIRE_FALSE(MemorySentinelSampler::start(1)); // already running
+    
+    auto waitForSamples = [](std::size_t numSamples) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (MemorySentinelSampler::getNumSamples() < numSamples && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+    waitForSamples(1);
+    
+    // grow the heap while being sampled
+    std::vector<float*> blocks;
+    blocks.reserve(20);
+    for (int i = 0; i < 20; ++i) {
+        blocks.push_back(new float[1024]);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    waitForSamples(MemorySentinelSampler::getNumSamples() + 2);
+    MemorySentinelSampler::stop();
+    REQUIRE_FALSE(MemorySentinelSampler::isRunning());
+    for (float* block : blocks) {
+        delete[] block;
+    }
+    MemorySentinel::setStatisticsEnabled(false);
+    
+    const std::size_t numSamples = MemorySentinelSampler::getNumSamples();
+    REQUIRE(numSamples >= 10);
+    std::vector<MemorySentinelSampler::Sample> samples(numSamples);
+    REQUIRE(MemorySentinelSampler::readSamples(samples.data(), samples.size()) == numSamples);
+    std::uint64_t sampledAllocations = 0;
+    for (std::size_t i = 0; i < numSamples; ++i) {
+        sampledAllocations += samples[i].allocations;
+        if (i > 0) {
+            REQUIRE(samples[i].timeNs > samples[i-1].timeNs);
+        }
+    }
+    REQUIRE(sampledAllocations >= 20);
+    REQUIRE(samples.back().liveBytes >= samples.front().liveBytes);
+    
+    // only the most recent samples
+    MemorySentinelSampler::Sample last[2];
+    REQUIRE(MemorySentinelSampler::readSamples(last, 2) == 2);
+    REQUIRE(last[1].timeNs == samples.back().timeNs);
+    
+    const std::string csv = captureOutput(MemorySentinelSampler::writeCsv);
+    REQUIRE(csv.find("time_ms,live_bytes,live_blocks,allocations_per_s,deallocations_per_s\n") == 0);
+    REQUIRE(std::count(csv.begin(), csv.end(), '\n') == static_cast<long>(numSamples + 1));
+    
+    const std::string json = captureOutput(MemorySentinelSampler::writeJson);
+    REQUIRE(json.find("[\n  {\"time_ms\": ") == 0);
+    REQUIRE(json.find("\"allocations_per_s\"") != std::string::npos);
+    REQUIRE(json.find("}\n]\n") != std::string::npos);
+#endif
+}
+
+TEST_CASE("MemorySentinelSampler Tests: sampling interval")
+{
+#if defined(__unix__) || defined(__APPLE__)
+    MemorySentinel::resetStatistics();
+    MemorySentinel::setStatisticsEnabled(true);
+    MemorySentinel::setSamplingInterval(4);
+    std::vector<float*> blocks;
+    blocks.reserve(40);
+    auto waitForSamples = [](std::size_t numSamples) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (MemorySentinelSampler::getNumSamples() < numSamples && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+    REQUIRE(MemorySentinelSampler::start(1));
+    waitForSamples(1);
+    for (int i = 0; i < 40; ++i) {
+        blocks.push_back(new float[16]); // only every 4th is counted
+    }
+    waitForSamples(MemorySentinelSampler::getNumSamples() + 2);
+    MemorySentinelSampler::stop();
+    MemorySentinel::setSamplingInterval(1);
+    MemorySentinel::setStatisticsEnabled(false);
+    for (float* block : blocks) {
+        delete[] block;
+    }
+    
+    std::vector<MemorySentinelSampler::Sample> samples(MemorySentinelSampler::getNumSamples());
+    REQUIRE(MemorySentinelSampler::readSamples(samples.data(), samples.size()) == samples.size());
+    std::uint64_t estimatedAllocations = 0;
+    for (const auto& sample : samples) {
+        REQUIRE(sample.allocations % 4 == 0);
+        estimatedAllocations += sample.allocations;
+    }
+    REQUIRE(estimatedAllocations >= 36); // scaled back up: ~40, not ~10
+#endif
+}
@@ -0,0 +1,249 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include <catch2/catch.hpp>
+
+#include "MemorySentinel.hpp"
+#include "MemorySentinelStatistics.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#if defined(__clang__) || defined(__GNUC__)
+    #define NOINLINE __attribute__((noinline))
+#else
+    #define NOINLINE __declspec(noinline)
+#endif
+
+static NOINLINE float* allocateFromThisCallSite() { return new float[1024]; }
+
+TEST_CASE("MemorySentinelStatistics Tests")
+{
+    MemorySentinel::resetStatistics();
+    MemorySentinel::setSamplingInterval(1);
+    
+    SECTION("disabled by default") {
+        REQUIRE_FALSE(MemorySentinel::isStatisticsEnabled());
+        auto* heapObject = new std::vector<float>(32);
+        delete heapObject;
+        REQUIRE(MemorySentinel::getStatistics().allocations == 0);
+    }
+    
+    SECTION("counters and live heap") {
+        MemorySentinel::setStatisticsEnabled(true);
+        float* block = allocateFromThisCallSite();
+        auto stats = MemorySentinel::getStatistics();
+        REQUIRE(stats.allocations >= 1);
+        REQUIRE(stats.allocatedBytes >= 1024 * sizeof(float));
+        REQUIRE(stats.liveBlocks >= 1);
+    #if defined(__GLIBC__) || defined(__APPLE__) || defined(_MSC_VER)
+        REQUIRE(stats.liveBytes >= 1024 * sizeof(float));
+    #endif
+        
+        MemorySentinel::CallSite top[4];
+        std::size_t count = MemorySentinel::getTopCallSites(top, 4);
+        REQUIRE(count >= 1);
+        REQUIRE(top[0].allocatedBytes == 1024 * sizeof(float)); // largest call site
+        REQUIRE(top[0].allocations == 1);
+        for (std::size_t i = 1; i < count; ++i) {
+            REQUIRE(top[i-1].allocatedBytes >= top[i].allocatedBytes);
+        }
+        
+        delete[] block;
+        MemorySentinel::setStatisticsEnabled(false);
+        stats = MemorySentinel::getStatistics();
+        REQUIRE(stats.deallocations >= 1);
+        REQUIRE(stats.liveBytes < 1024 * sizeof(float));
+    }
+    
+    SECTION("sampling") {
+        MemorySentinel::setSamplingInterval(4);
+        MemorySentinel::setStatisticsEnabled(true);
+        for (int i = 0; i < 16; ++i) {
+            delete[] allocateFromThisCallSite();
+        }
+        MemorySentinel::setStatisticsEnabled(false);
+        MemorySentinel::setSamplingInterval(1);
+        auto stats = MemorySentinel::getStatistics();
+        REQUIRE(stats.allocations + stats.deallocations == 8); // 32 events, every 4th is recorded
+    }
+    
+    SECTION("size histogram") {
+        MemorySentinel::setStatisticsEnabled(true);
+        constexpr int numSmall = 100;
+        for (int i = 0; i < numSmall; ++i) {
+            delete[] new char[40];
+        }
+        for (int i = 0; i < 3; ++i) {
+            delete[] new char[3000];
+        }
+        MemorySentinel::setStatisticsEnabled(false);
+        
+        MemorySentinel::SizeClass histogram[MemorySentinel::NUM_SIZE_CLASSES];
+        const std::size_t count = MemorySentinel::getSizeHistogram(histogram, MemorySentinel::NUM_SIZE_CLASSES);
+        REQUIRE(count >= 2);
+        std::uint64_t small = 0;
+        std::uint64_t large = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i > 0) {
+                REQUIRE(histogram[i-1].maxSize < histogram[i].maxSize);
+            }
+            small += histogram[i].maxSize == 40 ? histogram[i].allocations : 0;
+            large += histogram[i].maxSize == 3072 ? histogram[i].allocations : 0; // 2560 < 3000 <= 3072
+        }
+        REQUIRE(small >= numSmall);
+        REQUIRE(large >= 3);
+        
+        MemorySentinel::SizeClass suggested[4];
+        const std::size_t numSuggested = MemorySentinel::suggestSizeClasses(suggested, 4, 0.9);
+        REQUIRE(numSuggested >= 1);
+        bool suggestsSmall = false;
+        for (std::size_t i = 0; i < numSuggested; ++i) {
+            suggestsSmall |= suggested[i].maxSize == 40;
+        }
+        REQUIRE(suggestsSmall);
+        
+        MemorySentinel::resetStatistics();
+        REQUIRE(MemorySentinel::getSizeHistogram(histogram, MemorySentinel::NUM_SIZE_CLASSES) == 0);
+    }
+    
+    SECTION("size histogram: largest class (recorded directly)") {
+        // requests this large cannot succeed, so the hooks never record them: feed the histogram directly
+        const std::size_t hugeSize = std::numeric_limits<std::size_t>::max();
+        MemorySentinelStatistics::recordAllocation(hugeSize, hugeSize, nullptr);
+        
+        MemorySentinel::SizeClass histogram[MemorySentinel::NUM_SIZE_CLASSES];
+        const std::size_t count = MemorySentinel::getSizeHistogram(histogram, MemorySentinel::NUM_SIZE_CLASSES);
+        REQUIRE(count == 1);
+        REQUIRE(histogram[0].maxSize >= hugeSize);
+        REQUIRE(histogram[0].allocations == 1);
+        MemorySentinel::resetStatistics();
+    }
+    
+    SECTION("realloc growth chains (recorded directly)") {
+        // the realloc hook is not available everywhere (e.g. with glibc): feed the analysis like the hook would
+        static const char callSite = 0;
+        static const char otherCallSite = 0;
+        char blocks[4];
+        MemorySentinelStatistics::recordReallocation(&blocks[0], 64, &blocks[1], 128, &callSite);  // doubles
+        MemorySentinelStatistics::recordReallocation(&blocks[1], 128, &blocks[1], 160, &callSite); // in place
+        MemorySentinelStatistics::recordReallocation(&blocks[1], 160, &blocks[2], 192, &callSite);
+        MemorySentinelStatistics::recordReallocation(&blocks[2], 192, &blocks[2], 128, &callSite); // shrinks
+        MemorySentinelStatistics::recordReallocation(&blocks[2], 128, &blocks[3], 160, &callSite);
+        // a different call site or block starts a new chain
+        MemorySentinelStatistics::recordReallocation(&blocks[3], 64, &blocks[3], 128, &otherCallSite);
+        MemorySentinelStatistics::recordReallocation(&blocks[0], 64, &blocks[1], 256, &callSite);
+
+        MemorySentinel::ReallocSite top[8];
+        const std::size_t count = MemorySentinel::getTopReallocSites(top, 8);
+        const MemorySentinel::ReallocSite* site = nullptr;
+        const MemorySentinel::ReallocSite* otherSite = nullptr;
+        for (std::size_t i = 0; i < count; ++i) {
+            site = top[i].address == &callSite ? &top[i] : site;
+            otherSite = top[i].address == &otherCallSite ? &top[i] : otherSite;
+        }
+        REQUIRE(site != nullptr);
+        REQUIRE(site->growingReallocations == 5);           // the shrinking one is not counted
+        REQUIRE(site->smallStepGrowths == 3);               // growth factor < 1.5
+        REQUIRE(site->copiedBytes == 64 + 128 + 160 + 128 + 64);
+        REQUIRE(site->longestChain == 5);                   // the shrinking realloc still extends the chain
+        REQUIRE(otherSite != nullptr);
+        REQUIRE(otherSite->growingReallocations == 1);
+        REQUIRE(otherSite->smallStepGrowths == 0);
+        REQUIRE(otherSite->longestChain == 1);
+    }
+
+#if (defined(__clang__) || defined(__GNUC__)) && !defined(__GLIBC__)
+    SECTION("realloc growth chains") {
+        MemorySentinel::setStatisticsEnabled(true);
+        constexpr int numGrowths = 32;
+        void* linear = std::malloc(64);
+        for (int i = 2; i <= numGrowths + 1; ++i) {
+            linear = std::realloc(linear, i * 64); // grows by a constant step: quadratic copying
+        }
+        std::free(linear);
+        MemorySentinel::setStatisticsEnabled(false);
+        
+        MemorySentinel::ReallocSite top[4];
+        const std::size_t count = MemorySentinel::getTopReallocSites(top, 4);
+        REQUIRE(count >= 1);
+        REQUIRE(top[0].growingReallocations == numGrowths);
+        REQUIRE(top[0].smallStepGrowths >= numGrowths - 1); // the first step doubles
+        REQUIRE(top[0].longestChain == numGrowths);
+        REQUIRE(top[0].copiedBytes >= 64ull * numGrowths * (numGrowths + 1) / 2);
+    }
+#endif
+    
+    MemorySentinel::resetStatistics();
+}
+
+static const MemorySentinel::Tag* findTag(const MemorySentinel::Tag* tags, std::size_t count, const char* name)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        if (strcmp(tags[i].name, name) == 0) {
+            return &tags[i];
+        }
+    }
+    return nullptr;
+}
+
+TEST_CASE("MemorySentinelStatistics Tests: tagged scopes")
+{
+    using TransgressionBehaviour = MemorySentinel::TransgressionBehaviour;
+    MemorySentinel::resetStatistics();
+    
+    // two threads with equal tags from different strings are aggregated into the same tag
+    static const char workerTag[] = "test.worker";
+    static char workerTagCopy[sizeof(workerTag)];
+    strcpy(workerTagCopy, workerTag);
+    constexpr int numAllocations = 10;
+    auto worker = [](const char* tag) {
+        ScopedMemorySentinel sentinel(tag, 0, TransgressionBehaviour::SILENT);
+        for (int i = 0; i < numAllocations; ++i) {
+            delete[] allocateFromThisCallSite(); // allocation and deallocation are transgressions
+        }
+    };
+    std::thread first(worker, workerTag);
+    std::thread second(worker, workerTagCopy);
+    first.join();
+    second.join();
+    
+    // nested untagged scopes inherit the tag, and a scope within its quota has no transgressions
+    float* block = nullptr;
+    {
+        ScopedMemorySentinel outer("test.quota", 2 * 1024 * sizeof(float), TransgressionBehaviour::SILENT);
+        ScopedMemorySentinel inner(1024 * sizeof(float), TransgressionBehaviour::SILENT);
+        block = allocateFromThisCallSite();
+    }
+    delete[] block;
+    
+    MemorySentinel::Tag top[8];
+    const std::size_t count = MemorySentinel::getTopTags(top, 8);
+    REQUIRE(count >= 2);
+    REQUIRE(strcmp(top[0].name, workerTag) == 0); // most transgressions
+    for (std::size_t i = 1; i < count; ++i) {
+        REQUIRE(top[i-1].transgressions >= top[i].transgressions);
+    }
+    
+    const MemorySentinel::Tag* workers = findTag(top, count, workerTag);
+    REQUIRE(workers != nullptr);
+    REQUIRE(workers->allocations == 2 * numAllocations);
+    REQUIRE(workers->allocatedBytes == 2 * numAllocations * 1024 * sizeof(float));
+    REQUIRE(workers->transgressions == 2 * 2 * numAllocations);
+    
+    const MemorySentinel::Tag* quota = findTag(top, count, "test.quota");
+    REQUIRE(quota != nullptr);
+    REQUIRE(quota->allocations == 1);
+    REQUIRE(quota->transgressions == 0);
+    
+    MemorySentinel::resetStatistics();
+    REQUIRE(MemorySentinel::getTopTags(top, 8) == 0);
+}
@@ -10,8 +10,19 @@
 
 #include "MemorySentinel.hpp"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <thread>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+    #include <unistd.h>
+#endif
+
 // When exceptions are disabled (e.g. in coverage build), we redefine catch2's REQUIRE_THROWS, so we can compile.
 // Any REQUIRE_THROWS statements in tests will dissappear / do nothing
 #ifdef SLB_EXCEPTIONS_DISABLED
@@ -275,3 +286,388 @@ TEST_CASE("MemorySentinel Tests: zero allocation quota (default)")
         // delete not necessary, since we never allocated
     }
 }
+
+TEST_CASE("MemorySentinel Tests: configuration snapshots are consistent")
+{
+    // every publication changes allocationQuota and quotaGeneration together, so their difference is constant
+    MemorySentinel::setAllocationQuota(1);
+    const long long expectedOffset = 1 - static_cast<long long>(MemorySentinel::getConfig().quotaGeneration);
+    
+    std::atomic<bool> done { false };
+    std::atomic<int> inconsistentReads { 0 };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&]() {
+            while (!done.load()) {
+                const auto config = MemorySentinel::getConfig();
+                if (config.allocationQuota - static_cast<long long>(config.quotaGeneration) != expectedOffset) {
+                    inconsistentReads.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (int quota = 2; quota < 2000; ++quota) {
+        MemorySentinel::setAllocationQuota(quota);
+    }
+    done.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    
+    REQUIRE(inconsistentReads.load() == 0);
+    REQUIRE(MemorySentinel::getRemainingAllocationQuota() == 1999);
+    MemorySentinel::setAllocationQuota(0);
+    REQUIRE(MemorySentinel::getRemainingAllocationQuota() == 0);
+}
+
+TEST_CASE("MemorySentinel Tests: compile-time policy")
+{
+    using AllDisabled = MemorySentinelPolicy<false, true, true>;
+    static_assert(!AllDisabled::enabled && !AllDisabled::statistics && !AllDisabled::callSites, "");
+    using NoStatistics = MemorySentinelPolicy<true, false, true>;
+    static_assert(NoStatistics::enabled && !NoStatistics::statistics && !NoStatistics::callSites, "");
+    using NoCallSites = MemorySentinelPolicy<true, true, false>;
+    static_assert(NoCallSites::enabled && NoCallSites::statistics && !NoCallSites::callSites, "");
+    
+    // the tests are built with all features
+    REQUIRE(MemorySentinelActivePolicy::enabled);
+    REQUIRE(MemorySentinelActivePolicy::statistics);
+    REQUIRE(MemorySentinelActivePolicy::callSites);
+}
+
+TEST_CASE("MemorySentinel Tests: nested scopes")
+{
+    using TransgressionBehaviour = MemorySentinel::TransgressionBehaviour;
+    MemorySentinel& instance = MemorySentinel::getInstance();
+    const int arrayBytes = sizeof(float[32]);
+    
+    // NOTE: Catch's REQUIRE may allocate, therefore results are only checked once the scopes have exited
+    MemorySentinel::Scope innerResult;
+    MemorySentinel::Scope outerResult;
+    int innerDepth = 0;
+    bool armedAfterInnerExit = false;
+    int outerQuotaAfterInnerExit = 0;
+    {
+        ScopedMemorySentinel outer(arrayBytes, TransgressionBehaviour::SILENT);
+        {
+            // the inner scope has no quota: the allocation and deallocation are both transgressions
+            ScopedMemorySentinel inner(0, TransgressionBehaviour::SILENT);
+            innerDepth = instance.getScopeDepth();
+            delete[] allocWithNewArray();
+            innerResult = inner.getScope();
+        }
+        armedAfterInnerExit = instance.isArmed();
+        outerQuotaAfterInnerExit = MemorySentinel::getRemainingAllocationQuota();
+        
+        delete[] allocWithNewArray(); // allocation consumes the outer quota, deallocation is a transgression
+        delete[] allocWithNewArray(); // two transgressions
+        outerResult = outer.getScope();
+    }
+    
+    REQUIRE(innerDepth == 2);
+    REQUIRE(innerResult.allocations == 1);
+    REQUIRE(innerResult.allocatedBytes == arrayBytes);
+    REQUIRE(innerResult.transgressions == 2);
+    
+    // inner scope did not touch the outer quota, and did not disarm the sentinel
+    REQUIRE(armedAfterInnerExit);
+    REQUIRE(outerQuotaAfterInnerExit == arrayBytes);
+    
+    // inner results are rolled up into the outer scope
+    REQUIRE(outerResult.remainingQuota == 0);
+    REQUIRE(outerResult.allocations == 3);
+    REQUIRE(outerResult.allocatedBytes == 3*arrayBytes);
+    REQUIRE(outerResult.transgressions == 2 + 3);
+    
+    REQUIRE(instance.getScopeDepth() == 0);
+    REQUIRE_FALSE(instance.isArmed());
+    REQUIRE_FALSE(instance.hasTransgressionOccured());
+}
+
+TEST_CASE("MemorySentinel Tests: ScopedAllowAllocation")
+{
+    using TransgressionBehaviour = MemorySentinel::TransgressionBehaviour;
+    MemorySentinel& instance = MemorySentinel::getInstance();
+    MemorySentinel::resetStatistics();
+    
+    MemorySentinel::Scope result;
+    bool armedWhileAllowed = false;
+    bool transgressionWhileAllowed = true;
+    int quotaAfterAllowed = 0;
+    {
+        ScopedMemorySentinel sentinel(1, TransgressionBehaviour::SILENT);
+        {
+            ScopedAllowAllocation allow;
+            delete[] allocWithNewArray();
+            delete[] allocWithNewArray();
+            armedWhileAllowed = instance.isArmed();
+            transgressionWhileAllowed = instance.hasTransgressionOccured();
+        }
+        quotaAfterAllowed = MemorySentinel::getRemainingAllocationQuota();
+        delete[] allocWithNewArray(); // no longer exempt: transgression (the deallocation fits the remaining quota)
+        result = sentinel.getScope();
+    }
+    
+    REQUIRE(armedWhileAllowed);
+    REQUIRE_FALSE(transgressionWhileAllowed);
+    REQUIRE(quotaAfterAllowed == 1);
+    REQUIRE(result.exemptAllocations == 2);
+    REQUIRE(result.allocations == 1);
+    REQUIRE(result.transgressions == 1);
+    REQUIRE(MemorySentinel::getStatistics().exemptAllocations == 2);
+    REQUIRE_FALSE(instance.isAllocationAllowed());
+}
+
+TEST_CASE("MemorySentinel Tests: allowlist")
+{
+    using TransgressionBehaviour = MemorySentinel::TransgressionBehaviour;
+    MemorySentinel::clearAllowList();
+    
+    SECTION("ranges are merged") {
+        REQUIRE(MemorySentinel::allowCallerRange(reinterpret_cast<void*>(0x1000), reinterpret_cast<void*>(0x2000)));
+        REQUIRE(MemorySentinel::allowCallerRange(reinterpret_cast<void*>(0x1800), reinterpret_cast<void*>(0x3000)));
+        REQUIRE(MemorySentinel::allowCallerRange(reinterpret_cast<void*>(0x4000), reinterpret_cast<void*>(0x5000)));
+        REQUIRE(MemorySentinel::getAllowListSize() == 2);
+        REQUIRE_FALSE(MemorySentinel::allowCallerRange(reinterpret_cast<void*>(0x5000), reinterpret_cast<void*>(0x4000)));
+        REQUIRE_FALSE(MemorySentinel::allowSymbol("slb_no_such_symbol"));
+    #if defined(__GLIBC__)
+        REQUIRE(MemorySentinel::allowSymbol("malloc"));
+        REQUIRE(MemorySentinel::getAllowListSize() == 3);
+    #endif
+    }
+    
+#if defined(__linux__) || defined(__FreeBSD__)
+    SECTION("main executable") {
+        REQUIRE(MemorySentinel::allowSharedObject(nullptr));
+        REQUIRE_FALSE(MemorySentinel::allowSharedObject("libslb_not_loaded.so"));
+        
+        MemorySentinel::Scope allowed;
+        MemorySentinel::Scope reported;
+        {
+            ScopedMemorySentinel sentinel(0, TransgressionBehaviour::SILENT);
+            delete[] allocWithNewArray(); // called from the test executable
+            allowed = sentinel.getScope();
+            MemorySentinel::clearAllowList();
+            delete[] allocWithNewArray();
+            reported = sentinel.getScope();
+        }
+        REQUIRE(allowed.exemptAllocations == 1);
+        REQUIRE(allowed.transgressions == 0);
+        REQUIRE(reported.transgressions == 2);
+    }
+#endif
+    
+    MemorySentinel::clearAllowList();
+    REQUIRE(MemorySentinel::getAllowListSize() == 0);
+}
+
+TEST_CASE("MemorySentinel Tests: fallback pool")
+{
+    using TransgressionBehaviour = MemorySentinel::TransgressionBehaviour;
+    if (!MemorySentinel::setFallbackPoolEnabled(true, 4096)) {
+        return; // not supported on this platform
+    }
+    REQUIRE(MemorySentinel::isFallbackPoolEnabled());
+    const MemorySentinel::FallbackPoolStatistics before = MemorySentinel::getFallbackPoolStatistics();
+    
+    char* survivor = nullptr;
+    MemorySentinel::FallbackPoolStatistics during;
+    {
+        ScopedMemorySentinel sentinel(1024 * 1024, TransgressionBehaviour::SILENT);
+        char* blocks[3];
+        for (char*& block : blocks) {
+            block = new char[100]; // permitted: served by the pool
+            memset(block, 0x5A, 100);
+        }
+        REQUIRE(blocks[0] != blocks[1]);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(blocks[2]) % alignof(std::max_align_t) == 0);
+        survivor = new char[4000]; // the only block of its size class
+        char* exhausted = new char[4000]; // served by malloc
+        during = MemorySentinel::getFallbackPoolStatistics();
+        delete[] exhausted;
+        for (char* block : blocks) {
+            delete[] block;
+        }
+    }
+    REQUIRE(during.allocations - before.allocations == 4);
+    REQUIRE(during.exhaustions - before.exhaustions == 1);
+    REQUIRE(during.blocksInUse - before.blocksInUse == 4);
+    
+    delete[] survivor; // recognized by address, also while unarmed
+    REQUIRE(MemorySentinel::getFallbackPoolStatistics().blocksInUse == before.blocksInUse);
+    
+    REQUIRE(MemorySentinel::setFallbackPoolEnabled(false));
+    {
+        ScopedMemorySentinel sentinel(1024, TransgressionBehaviour::SILENT);
+        delete[] new char[100];
+    }
+    REQUIRE(MemorySentinel::getFallbackPoolStatistics().allocations == during.allocations);
+    
+#if defined(__unix__) || defined(__APPLE__)
+    // permitted allocations are logged (with LOG), but not when the pool serves them: stdio may lock
+    const auto stdoutBytesOfPermittedAllocation = []() {
+        std::FILE* capture = std::tmpfile();
+        std::fflush(stdout);
+        const int originalStdout = dup(1);
+        dup2(fileno(capture), 1);
+        char* block = nullptr;
+        {
+            ScopedMemorySentinel sentinel(1024, TransgressionBehaviour::LOG);
+            block = new char[100];
+        }
+        std::fflush(stdout);
+        dup2(originalStdout, 1);
+        close(originalStdout);
+        delete[] block;
+        const off_t numBytes = lseek(fileno(capture), 0, SEEK_END);
+        std::fclose(capture);
+        return numBytes;
+    };
+    REQUIRE(MemorySentinel::setFallbackPoolEnabled(true, 4096));
+    REQUIRE(stdoutBytesOfPermittedAllocation() == 0);
+    REQUIRE(MemorySentinel::setFallbackPoolEnabled(false));
+    REQUIRE(stdoutBytesOfPermittedAllocation() > 0);
+#endif
+}
+
+TEST_CASE("MemorySentinel Tests: redirect to arena")
+{
+    alignas(std::max_align_t) static char arena[1024];
+    const auto isInArena = [](const void* ptr) { return ptr >= arena && ptr < arena + sizeof(arena); };
+    
+    float* first = nullptr;
+    int* second = nullptr;
+    const int* elements = nullptr;
+    bool threwWhenExhausted = false;
+    MemorySentinel::Scope result;
+    {
+        ScopedMemorySentinel sentinel(MemorySentinel::RedirectArena{arena, sizeof(arena)});
+        first = new float[4];
+        delete[] first; // no-op
+        second = new int(42);
+        std::vector<int> container(8, 1);
+        elements = container.data();
+        try {
+            delete[] new char[2 * sizeof(arena)];
+        } catch (const std::bad_alloc&) {
+            threwWhenExhausted = true;
+        }
+        result = sentinel.getScope();
+    }
+    REQUIRE(isInArena(first));
+    REQUIRE(isInArena(second));
+    REQUIRE(isInArena(elements));
+    REQUIRE(static_cast<const void*>(second) != static_cast<const void*>(first));
+    REQUIRE(reinterpret_cast<std::uintptr_t>(second) % alignof(std::max_align_t) == 0);
+    REQUIRE(*second == 42);
+    REQUIRE(threwWhenExhausted);
+    REQUIRE(result.redirectedAllocations == 3);
+    REQUIRE(result.transgressions == 4);
+    REQUIRE_FALSE(MemorySentinel::getInstance().isArmed());
+    
+    // the arena is reset when the scope exits
+    float* again = nullptr;
+    {
+        ScopedMemorySentinel sentinel(MemorySentinel::RedirectArena{arena, sizeof(arena)}, "test.redirect");
+        again = new float[4];
+        delete[] again;
+    }
+    REQUIRE(again == first);
+    
+    // nested scopes with other behaviours are not redirected
+    bool threwInNestedScope = false;
+    {
+        ScopedMemorySentinel outer(MemorySentinel::RedirectArena{arena, sizeof(arena)});
+        ScopedMemorySentinel inner(0, MemorySentinel::TransgressionBehaviour::THROW_EXCEPTION);
+        try {
+            delete new int;
+        } catch (const std::bad_alloc&) {
+            threwInNestedScope = true;
+        }
+    }
+    REQUIRE(threwInNestedScope);
+}
+
+TEST_CASE("MemorySentinel Tests: context restored across threads")
+{
+    using TransgressionBehaviour = MemorySentinel::TransgressionBehaviour;
+    MemorySentinel::Context context;
+    MemorySentinel::Scope originResult;
+    {
+        ScopedMemorySentinel sentinel("test.task", 64, TransgressionBehaviour::SILENT);
+        context = MemorySentinel::captureContext();
+        originResult = sentinel.getScope();
+    }
+    REQUIRE(context.captured);
+    REQUIRE(context.scope.remainingQuota == 64);
+    REQUIRE(context.scope.allocations == 0);
+    
+    // two hops onto other threads: the counters and the quota travel with the context
+    bool armedOnWorker = false;
+    int depthOnWorker = 0;
+    std::thread([&context, &armedOnWorker, &depthOnWorker] {
+        ScopedContextRestore restore(context);
+        armedOnWorker = MemorySentinel::getConfig().hijackActive;
+        depthOnWorker = MemorySentinel::getInstance().getScopeDepth();
+        delete new int; // permitted
+    }).join();
+    std::thread([&context] {
+        ScopedContextRestore restore(context);
+        delete[] new float[32]; // exceeds the remaining quota
+    }).join();
+    
+    REQUIRE(armedOnWorker);
+    REQUIRE(depthOnWorker == 1);
+    REQUIRE(context.scope.tag != nullptr);
+    REQUIRE(std::strcmp(context.scope.tag, "test.task") == 0);
+    REQUIRE(context.scope.allocations == 2);
+    REQUIRE(context.scope.allocatedBytes == sizeof(int) + sizeof(float[32]));
+    REQUIRE(context.scope.transgressions == 1);
+    REQUIRE(context.scope.remainingQuota == 64 - static_cast<int>(sizeof(int)));
+    REQUIRE(originResult.allocations == 0);
+    REQUIRE_FALSE(MemorySentinel::getConfig().hijackActive);
+    
+    // the origin scope exits while the continuation runs (and vice versa): neither disarms the other
+    std::promise<void> restored;
+    std::promise<void> originExited;
+    bool armedAfterOriginExit = false;
+    bool armedAfterWorkerExit = false;
+    std::uint64_t continuationTransgressions = 0;
+    std::thread worker;
+    {
+        ScopedMemorySentinel sentinel("test.overlap", 0, TransgressionBehaviour::SILENT);
+        MemorySentinel::Context overlapping = MemorySentinel::captureContext();
+        worker = std::thread([&, overlapping]() mutable {
+            {
+                ScopedContextRestore restore(overlapping);
+                restored.set_value();
+                originExited.get_future().wait();
+                armedAfterOriginExit = MemorySentinel::getConfig().hijackActive;
+                delete new int; // still monitored
+            }
+            continuationTransgressions = overlapping.scope.transgressions;
+        });
+        restored.get_future().wait();
+    }
+    originExited.set_value();
+    worker.join();
+    REQUIRE(armedAfterOriginExit);
+    REQUIRE(continuationTransgressions > 0);
+    REQUIRE_FALSE(MemorySentinel::getConfig().hijackActive);
+    {
+        ScopedMemorySentinel sentinel("test.overlap", 0, TransgressionBehaviour::SILENT);
+        MemorySentinel::Context overlapping = MemorySentinel::captureContext();
+        std::thread([&overlapping] { ScopedContextRestore restore(overlapping); }).join();
+        armedAfterWorkerExit = MemorySentinel::getConfig().hijackActive;
+    }
+    REQUIRE(armedAfterWorkerExit);
+    REQUIRE_FALSE(MemorySentinel::getConfig().hijackActive);
+
+    // captured outside of any scope: restoring does nothing
+    MemorySentinel::Context unscoped = MemorySentinel::captureContext();
+    REQUIRE_FALSE(unscoped.captured);
+    {
+        ScopedContextRestore restore(unscoped);
+        REQUIRE(MemorySentinel::getInstance().getScopeDepth() == 0);
+    }
+}
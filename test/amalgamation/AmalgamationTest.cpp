@@ -0,0 +1,34 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+// Builds the whole sentinel from the generated single header in one translation unit and checks that the
+// replacement operator new is in effect. Returns 0 on success.
+
+#define SLB_MEMORY_SENTINEL_IMPLEMENTATION
+#include "MemorySentinel.hpp"
+
+#include <cstdio>
+#include <new>
+
+int main()
+{
+    MemorySentinel& sentinel = MemorySentinel::getInstance();
+    MemorySentinel::setTransgressionBehaviour(MemorySentinel::TransgressionBehaviour::SILENT);
+    sentinel.clearTransgressions();
+    
+    sentinel.setArmed(true);
+    void* block = ::operator new(64);
+    sentinel.setArmed(false);
+    ::operator delete(block);
+    
+    if (!sentinel.getAndClearTransgressionsOccured()) {
+        printf("replacement operator new was not linked\n");
+        return 1;
+    }
+    return 0;
+}
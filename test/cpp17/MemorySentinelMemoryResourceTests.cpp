@@ -0,0 +1,119 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include <catch2/catch.hpp>
+
+#include "MemorySentinelMemoryResource.hpp"
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+/** Upstream that counts its allocations (and forwards to the heap) */
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    int allocations = 0;
+    int deallocations = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+    {
+        deallocations++;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+TEST_CASE("SentinelMemoryResource Tests")
+{
+    using TransgressionBehaviour = MemorySentinel::TransgressionBehaviour;
+    MemorySentinel::resetStatistics();
+    
+    SECTION("statistics are recorded once") {
+        CountingResource upstream;
+        SentinelMemoryResource resource(&upstream);
+        MemorySentinel::setStatisticsEnabled(true);
+        {
+            std::pmr::vector<int> values(&resource);
+            for (int i = 0; i < 100; ++i) {
+                values.push_back(i);
+            }
+        }
+        MemorySentinel::setStatisticsEnabled(false);
+        const MemorySentinel::Statistics stats = MemorySentinel::getStatistics();
+        REQUIRE(upstream.allocations > 0);
+        REQUIRE(stats.allocations == static_cast<std::uint64_t>(upstream.allocations));
+        REQUIRE(stats.deallocations == static_cast<std::uint64_t>(upstream.deallocations));
+        REQUIRE(stats.liveBytes == 0);
+    }
+    
+    SECTION("quota and behaviour apply to a buffer resource") {
+        alignas(std::max_align_t) std::byte storage[1024];
+        std::pmr::monotonic_buffer_resource buffer(storage, sizeof(storage), std::pmr::null_memory_resource());
+        SentinelMemoryResource resource(&buffer);
+        void* permitted = nullptr;
+        bool threw = false;
+        MemorySentinel::Scope result;
+        {
+            ScopedMemorySentinel sentinel(64, TransgressionBehaviour::THROW_EXCEPTION);
+            permitted = resource.allocate(48);
+            try {
+                (void) resource.allocate(32); // exceeds the quota
+            } catch (const std::bad_alloc&) {
+                threw = true;
+            }
+            result = sentinel.getScope();
+        }
+        REQUIRE(permitted >= static_cast<void*>(storage));
+        REQUIRE(permitted < static_cast<void*>(storage + sizeof(storage)));
+        REQUIRE(threw);
+        REQUIRE(result.allocations == 2);
+        REQUIRE(result.transgressions == 1);
+    }
+    
+    SECTION("chained below a buffer resource") {
+        CountingResource upstream;
+        SentinelMemoryResource resource(&upstream);
+        std::pmr::monotonic_buffer_resource buffer(&resource);
+        MemorySentinel::Scope result;
+        {
+            ScopedMemorySentinel sentinel(0, TransgressionBehaviour::SILENT);
+            for (int i = 0; i < 16; ++i) {
+                (void) buffer.allocate(16);
+            }
+            result = sentinel.getScope();
+        }
+        buffer.release();
+        REQUIRE(result.transgressions == static_cast<std::uint64_t>(upstream.allocations)); // one per chunk
+        REQUIRE(upstream.allocations < 16);
+    }
+    
+    SECTION("redirect") {
+        alignas(std::max_align_t) static char arena[256];
+        CountingResource upstream;
+        SentinelMemoryResource resource(&upstream);
+        void* block = nullptr;
+        {
+            ScopedMemorySentinel sentinel(MemorySentinel::RedirectArena{arena, sizeof(arena)});
+            block = resource.allocate(32);
+            resource.deallocate(block, 32);
+        }
+        REQUIRE(block == static_cast<void*>(arena));
+        REQUIRE(upstream.allocations == 0);
+        REQUIRE(upstream.deallocations == 0);
+    }
+    
+    MemorySentinel::resetStatistics();
+}
@@ -0,0 +1,118 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include <catch2/catch.hpp>
+
+#include "MemorySentinelCoroutine.hpp"
+
+#include <coroutine>
+#include <cstring>
+#include <exception>
+#include <utility>
+
+/** Minimal lazily started coroutine that yields a value when resumed */
+struct Job
+{
+    struct promise_type : SentinelPromiseMixin<promise_type>
+    {
+        int value = 0;
+        Job get_return_object() { return Job(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(int v) { value = v; }
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit Job(std::coroutine_handle<promise_type> h) : handle(h) {}
+    Job(Job&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    ~Job() { if (handle) { handle.destroy(); } }
+
+    int run() { handle.resume(); return handle.promise().value; }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+static Job twice(int x)
+{
+    int buffer[32] = {};
+    buffer[x % 32] = x;
+    co_return 2 * buffer[x % 32];
+}
+
+TEST_CASE("Coroutine Frame Tests")
+{
+    using TransgressionBehaviour = MemorySentinel::TransgressionBehaviour;
+    MemorySentinel::resetStatistics();
+    
+    SECTION("frames are counted per promise type") {
+        const SentinelCoroutineFrameStatistics before = Job::promise_type::getFrameStatistics();
+        {
+            Job job = twice(21);
+            REQUIRE(job.run() == 42);
+            REQUIRE(Job::promise_type::getFrameStatistics().liveFrames == before.liveFrames + 1);
+        }
+        const SentinelCoroutineFrameStatistics after = Job::promise_type::getFrameStatistics();
+        REQUIRE(after.frames == before.frames + 1);
+        REQUIRE(after.frameBytes - before.frameBytes >= 32 * sizeof(int));
+        REQUIRE(after.maxFrameSize >= 32 * sizeof(int));
+        REQUIRE(after.liveFrames == before.liveFrames);
+    }
+    
+    SECTION("frames are reported per tag") {
+        MemorySentinel::setStatisticsEnabled(true);
+        {
+            Job job = twice(1);
+            job.run();
+        }
+        MemorySentinel::setStatisticsEnabled(false);
+        MemorySentinel::Tag top[16];
+        const std::size_t count = MemorySentinel::getTopTags(top, 16);
+        bool found = false;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (strstr(top[i].name, "coroutine frame [") != nullptr && strstr(top[i].name, "promise_type") != nullptr) {
+                found = top[i].allocations == 1;
+            }
+        }
+        REQUIRE(found);
+    }
+    
+    SECTION("frame allocations are subject to armed scopes") {
+        MemorySentinel::Scope result;
+        {
+            ScopedMemorySentinel sentinel(0, TransgressionBehaviour::SILENT);
+            Job job = twice(3);
+            job.run();
+            result = sentinel.getScope();
+        }
+        REQUIRE(result.transgressions >= 1);
+    }
+    
+    SECTION("elision check") {
+        std::uint64_t initialFrameAllocations = 0;
+        std::uint64_t frameAllocations = 0;
+        MemorySentinel::Scope result;
+        {
+            ScopedMemorySentinel sentinel(0, TransgressionBehaviour::SILENT);
+            ScopedCoroutineElisionCheck check(false);
+            initialFrameAllocations = check.getFrameAllocations();
+            Job job = twice(4);
+            job.run();
+            frameAllocations = check.getFrameAllocations();
+            result = sentinel.getScope();
+        }
+        REQUIRE(initialFrameAllocations == 0);
+        // whether the compiler elides the frame is up to it: the check sees exactly the allocations the sentinel saw
+        REQUIRE(frameAllocations <= 1);
+        REQUIRE(frameAllocations == result.allocations);
+        {
+            ScopedCoroutineElisionCheck check; // no coroutines: passes
+        }
+    }
+    
+    MemorySentinel::resetStatistics();
+}
@@ -0,0 +1,90 @@
+//
+//  ╔╦╗┌─┐┌┬┐┌─┐┬─┐┬ ┬  ╔═╗┌─┐┌┐┌┌┬┐┬┌┐┌┌─┐┬
+//  ║║║├┤ ││││ │├┬┘└┬┘  ╚═╗├┤ │││ │ ││││├┤ │
+//  ╩ ╩└─┘┴ ┴└─┘┴└─ ┴   ╚═╝└─┘┘└┘ ┴ ┴┘└┘└─┘┴─┘
+//
+//  © 2025 Lorenz Bucher - all rights reserved
+//  https://github.com/Sidelobe/MemorySentinel
+
+#include "MemorySentinelGTest.hpp"
+
+#include <gtest/gtest-spi.h>
+
+#include <string>
+#include <vector>
+
+static MemorySentinelGTest::AllocationListener* listener = nullptr;
+
+TEST(MemorySentinelGTest, NoAllocations)
+{
+    std::vector<int> values;
+    values.reserve(16);
+    EXPECT_NO_ALLOCATIONS(values.push_back(1));
+    ASSERT_NO_ALLOCATIONS(values.push_back(2));
+    EXPECT_NO_ALLOCATIONS({ ScopedAllowAllocation allow; delete new int; }); // exempt
+    EXPECT_FALSE(MemorySentinel::getInstance().isArmed());
+}
+
+TEST(MemorySentinelGTest, NoAllocationsFails)
+{
+    EXPECT_NONFATAL_FAILURE(EXPECT_NO_ALLOCATIONS(delete new int), "made 1 allocation(s)");
+    EXPECT_FATAL_FAILURE(ASSERT_NO_ALLOCATIONS(delete[] new char[8]), "of 8 bytes");
+}
+
+TEST(MemorySentinelGTest, MaxAllocatedBytes)
+{
+    EXPECT_MAX_ALLOCATED_BYTES(delete[] new char[64], 64);
+    ASSERT_MAX_ALLOCATED_BYTES(delete[] new char[64], 100);
+    EXPECT_NONFATAL_FAILURE(EXPECT_MAX_ALLOCATED_BYTES(delete[] new char[65], 64), "expected at most 64");
+}
+
+TEST(MemorySentinelGTest, WithinArmedScope)
+{
+    MemorySentinel::Scope outer;
+    {
+        ScopedMemorySentinel sentinel(0, MemorySentinel::TransgressionBehaviour::SILENT);
+        EXPECT_NONFATAL_FAILURE(EXPECT_NO_ALLOCATIONS(delete new int), "allocation");
+        outer = sentinel.getScope();
+    }
+    EXPECT_GE(outer.allocations, 1u); // rolled up into the enclosing scope
+}
+
+/** The most recent record of a test (with --gtest_repeat, each iteration adds one) */
+static const MemorySentinelGTest::Record* findRecord(const std::vector<MemorySentinelGTest::Record>& records, const std::string& name)
+{
+    for (auto record = records.rbegin(); record != records.rend(); ++record) {
+        if (record->name == name) {
+            return &*record;
+        }
+    }
+    return nullptr;
+}
+
+TEST(MemorySentinelGTest, ListenerRecordsTests)
+{
+    ASSERT_NE(listener, nullptr);
+    const std::vector<MemorySentinelGTest::Record>& records = listener->getRecords();
+    const ::testing::UnitTest& unitTest = *::testing::UnitTest::GetInstance();
+    const ::testing::TestSuite& suite = *unitTest.current_test_suite();
+    // only the tests that already ran in this iteration (robust to --gtest_shuffle, --gtest_filter and --gtest_repeat)
+    for (int i = 0; i < suite.total_test_count(); ++i) {
+        const ::testing::TestInfo& testInfo = *suite.GetTestInfo(i);
+        if (&testInfo == unitTest.current_test_info() || testInfo.result()->start_timestamp() == 0) {
+            continue;
+        }
+        const std::string name = std::string(suite.name()) + "." + testInfo.name();
+        const MemorySentinelGTest::Record* record = findRecord(records, name);
+        ASSERT_NE(record, nullptr) << name;
+        if (std::string(testInfo.name()) == "MaxAllocatedBytes") {
+            EXPECT_GE(record->allocations, 3u);
+            EXPECT_GE(record->allocatedBytes, 64u + 64u + 65u);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    listener = MemorySentinelGTest::installListener();
+    return RUN_ALL_TESTS();
+}
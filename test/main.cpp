@@ -10,3 +10,6 @@
 #define CATCH_CONFIG_MAIN
 
 #include <catch2/catch.hpp>
+
+// Reports the allocations per test case if MEMORY_SENTINEL_REPORT is set
+#include "MemorySentinelCatch2.hpp"